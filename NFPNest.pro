@@ -9,11 +9,13 @@ include($$PWD/nest/LB_Nest.pri)
 HEADERS += \
     NestConfigWidget.h \
     Strip.h \
+    StripItem.h \
     mainwindow.h
 
 SOURCES += \
     NestConfigWidget.cpp \
     Strip.cpp \
+    StripItem.cpp \
     main.cpp \
     mainwindow.cpp
 	
@@ -1,9 +1,6 @@
 #include "NestConfigWidget.h"
 #include "ui_NestConfigWidget.h"
 
-#include "nest/LB_NestConfig.h"
-using namespace NestConfig;
-
 NestConfigWidget::NestConfigWidget(QWidget *parent) :
     QDialog(parent),
     ui(new Ui::NestConfigWidget)
@@ -67,8 +64,8 @@ void NestConfigWidget::on_pushButton_cancle_clicked()
 
 void NestConfigWidget::apply()
 {
-    LB_NestConfig::STRIP_WIDTH = ui->lineEdit_stripWidth->text().toDouble();
-    LB_NestConfig::STRIP_HEIGHT = ui->lineEdit_stripHeight->text().toDouble();
-    LB_NestConfig::ENABLE_ROTATION = 1-ui->comboBox_enableRotation->currentIndex();
-    LB_NestConfig::ITEM_GAP = ui->lineEdit_itemGap->text().toDouble();
+    config.SetStripWidth(ui->lineEdit_stripWidth->text().toDouble());
+    config.SetStripHeight(ui->lineEdit_stripHeight->text().toDouble());
+    config.SetEnableRotation(1-ui->comboBox_enableRotation->currentIndex());
+    config.SetItemGap(ui->lineEdit_itemGap->text().toDouble());
 }
@@ -3,6 +3,9 @@
 
 #include <QDialog>
 
+#include "nest/LB_NestConfig.h"
+using namespace NestConfig;
+
 namespace Ui {
 class NestConfigWidget;
 }
@@ -15,6 +18,10 @@ public:
     explicit NestConfigWidget(QWidget *parent = nullptr);
     ~NestConfigWidget();
 
+    const LB_NestConfig &Config() const {
+        return config;
+    }
+
 private slots:
     void on_comboBox_stripSize_currentTextChanged(const QString &arg1);
     void on_lineEdit_stripWidth_editingFinished();
@@ -25,6 +32,8 @@ private slots:
 private:
     Ui::NestConfigWidget *ui;
 
+    LB_NestConfig config;
+
     void apply();
 };
 
@@ -1,22 +1,37 @@
 #include "Strip.h"
+#include "StripItem.h"
 
 #include <QGraphicsPolygonItem>
 #include <QGraphicsRectItem>
-#include <QPainter>
 #include <QDebug>
 
-#include "nest/LB_NestConfig.h"
-using namespace NestConfig;
-
-const double & stripWid = LB_NestConfig::STRIP_WIDTH;
-const double & stripHei = LB_NestConfig::STRIP_HEIGHT;
-const double & pieceGap = LB_NestConfig::ITEM_GAP;
+// layouts with more parts are shown in batch view by AutoView
+const int BATCH_VIEW_PARTS = 2000;
+// vertex buffers kept for strips out of view
+const int MAX_LOADED_STRIPS = 32;
 
 Strip::Strip() : stripNb(0)
 {
     InitSize();
 }
 
+Strip::ViewMode Strip::GetViewMode() const
+{
+    return viewMode;
+}
+
+void Strip::SetViewMode(Strip::ViewMode mode)
+{
+    viewMode = mode;
+}
+
+bool Strip::IsBatchView() const
+{
+    if(viewMode == AutoView)
+        return parts.size() > BATCH_VIEW_PARTS;
+    return viewMode == BatchView;
+}
+
 double Strip::getSceneWidth() const
 {
     return this->sceneRect().width();
@@ -29,27 +44,37 @@ double Strip::getSceneHeight() const
 
 double Strip::getStripWidth() const
 {
-    return stripWid;
+    return config.StripWidth();
 }
 
 double Strip::getStripHeight() const
 {
-    return stripHei;
+    return config.StripHeight();
+}
+
+void Strip::SetConfig(const LB_NestConfig &aConfig)
+{
+    config = aConfig;
+}
+
+void Strip::SetParts(const QVector<LB_Polygon2D> &partVec)
+{
+    parts = partVec;
 }
 
 void Strip::Reset()
 {
     this->clear();
     InitSize();
-    for(int i=0;i<stripNb;++i) {
-        stripUsed[i] = 0;
-    }
+    stripUsed.clear();
+    strips.clear();
+    loadedStrips.clear();
     stripNb = 0;
 }
 
 void Strip::InitSize()
 {
-    this->setSceneRect(0,0,stripWid,stripHei);
+    this->setSceneRect(0,0,config.StripWidth(),config.StripHeight());
 }
 
 int Strip::GetUsedNumber() const
@@ -59,22 +84,26 @@ int Strip::GetUsedNumber() const
 
 double Strip::GetUtilization(int index) const
 {
-    return stripUsed[index];
-}
-
-QImage Strip::DumpToImage()
-{
-    QImage result(sceneRect().size().toSize(),QImage::Format_ARGB32);
-    QPainter aPainter(&result);
-    aPainter.setRenderHints(aPainter.renderHints() | QPainter::Antialiasing);
-    this->render(&aPainter);
-    return result;
+    return stripUsed.value(index);
 }
 
 void Strip::AddOneStrip()
 {
+    const double stripWid = config.StripWidth();
+    const double stripHei = config.StripHeight();
+
     stripNb++;
+    stripUsed.append(0);
     setSceneRect(0,0,stripNb*stripWid,stripHei);
+
+    if(IsBatchView()) {
+        StripItem *aStrip = new StripItem(this,&parts,stripWid,stripHei);
+        aStrip->setPos((stripNb-1)*stripWid,0);
+        strips.append(aStrip);
+        addItem(aStrip);
+        return;
+    }
+
     QGraphicsRectItem *rect = new QGraphicsRectItem(QRectF((stripNb-1)*stripWid,
                                                            0,
                                                            stripWid,
@@ -83,17 +112,31 @@ void Strip::AddOneStrip()
     addItem(rect);
 }
 
-void Strip::AddOneItem(LB_Polygon2D poly)
+void Strip::AddPlacements(const QVector<LB_Placement> &placements)
 {
+    foreach(const LB_Placement &aPlacement,placements) {
+        while(aPlacement.stripID >= stripNb)
+            AddOneStrip();
+        AddOneItem(aPlacement);
+    }
+}
+
+void Strip::AddOneItem(const LB_Placement &placement)
+{
+    const LB_Polygon2D &part = parts[placement.partID];
+
     // add the area to array
-    if(pieceGap != 0) {
-        poly = poly.Shrinking(pieceGap);
+    stripUsed[placement.stripID] += abs(part.Area());
+
+    if(IsBatchView()) {
+        strips[placement.stripID]->AddPlacement(placement,RandomColor());
+        return;
     }
 
-    stripUsed[poly.ID()] += abs(poly.Area());
+    LB_Polygon2D poly = placement.Apply(part);
 
     // move the item to the correct strip
-    poly.Translate(poly.ID()*stripWid,0);
+    poly.Translate(poly.ID()*config.StripWidth(),0);
     QPolygonF target = poly.ToPolygonF();
 
     // add the item
@@ -103,3 +146,15 @@ void Strip::AddOneItem(LB_Polygon2D poly)
     anItem->setFlags(QGraphicsItem::ItemIsMovable);
     addItem(anItem);
 }
+
+void Strip::StripLoaded(StripItem *item)
+{
+    loadedStrips.removeOne(item);
+    loadedStrips.append(item);
+
+    // free the strips painted longest ago
+    while(loadedStrips.size() > MAX_LOADED_STRIPS) {
+        StripItem *oldest = loadedStrips.takeFirst();
+        oldest->Release();
+    }
+}
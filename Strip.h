@@ -2,36 +2,68 @@
 #define STRIP_H
 
 #include <QGraphicsScene>
+#include <QList>
 
 #include "nest/LB_Polygon2D.h"
+#include "nest/LB_NestConfig.h"
+#include "nest/LB_Placement.h"
 using namespace Shape2D;
 
+class StripItem;
+using namespace NestConfig;
+
 class Strip : public QGraphicsScene
 {
 public:
+    // ItemView makes every part a movable item, BatchView draws every
+    // strip as one item for large layouts, AutoView picks by part count
+    enum ViewMode {
+        AutoView,
+        ItemView,
+        BatchView
+    };
+
     Strip();
 
+    ViewMode GetViewMode() const;
+    void SetViewMode(ViewMode mode);
+
     double getSceneWidth() const;
     double getSceneHeight() const;
 
     double getStripWidth() const;
     double getStripHeight() const;
 
+    void SetConfig(const LB_NestConfig &aConfig);
+    // the parts the placements refer to
+    void SetParts(const QVector<LB_Polygon2D> &partVec);
+
     void Reset();
     void InitSize();
 
     int GetUsedNumber() const;
     double GetUtilization(int index) const;
 
-    QImage DumpToImage();
+    void AddPlacements(const QVector<LB_Placement> &placements);
+
+    // called by a strip item which built its vertex buffer
+    void StripLoaded(StripItem *item);
 
 public slots:
     void AddOneStrip();
-    void AddOneItem(LB_Polygon2D poly);
 
 private:
+    bool IsBatchView() const;
+    void AddOneItem(const LB_Placement &placement);
+
+    LB_NestConfig config;
+    QVector<LB_Polygon2D> parts;
+    ViewMode viewMode = AutoView;
     int stripNb;
-    double stripUsed[99]={0};
+    QVector<double> stripUsed;
+    QVector<StripItem*> strips;
+    // loaded strips, the most recently painted last
+    QList<StripItem*> loadedStrips;
 };
 
 #endif // STRIP_H
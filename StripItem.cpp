@@ -0,0 +1,112 @@
+#include "StripItem.h"
+#include "Strip.h"
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+// below these sizes in pixels, a strip is drawn as a block
+// and a part as its bounding box
+const double LOD_STRIP_PIXELS = 64;
+const double LOD_PART_PIXELS = 4;
+
+StripItem::StripItem(Strip *owner, const QVector<LB_Polygon2D> *partVec,
+                     double stripWid, double stripHei) :
+    owner(owner),
+    parts(partVec),
+    rect(0,0,stripWid,stripHei)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    offsets.append(0);
+}
+
+QRectF StripItem::boundingRect() const
+{
+    return rect;
+}
+
+void StripItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+
+    const qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+
+    painter->setPen(QColor(Qt::red));
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(rect);
+
+    // the whole strip is only a few pixels, no need to load it
+    if(lod*qMin(rect.width(),rect.height()) < LOD_STRIP_PIXELS) {
+        painter->fillRect(rect,QColor(128,128,128,128));
+        return;
+    }
+
+    Load();
+
+    painter->setPen(Qt::NoPen);
+    const QRectF &exposed = option->exposedRect;
+    for(int i=0;i<placements.size();++i) {
+        const QRectF &box = bounds.at(i);
+        if(!box.intersects(exposed))
+            continue;
+
+        painter->setBrush(QColor(colors.at(i)));
+        if(lod*qMax(box.width(),box.height()) < LOD_PART_PIXELS) {
+            painter->drawRect(box);
+        }
+        else {
+            painter->drawPolygon(vertices.constData()+offsets.at(i),
+                                 offsets.at(i+1)-offsets.at(i));
+        }
+    }
+}
+
+void StripItem::AddPlacement(const LB_Placement &placement, const QColor &color)
+{
+    placements.append(placement);
+    colors.append(color.rgba());
+
+    if(loaded) {
+        LoadOne(placements.size()-1);
+        update(bounds.last());
+    }
+}
+
+int StripItem::Count() const
+{
+    return placements.size();
+}
+
+bool StripItem::IsLoaded() const
+{
+    return loaded;
+}
+
+void StripItem::Release()
+{
+    loaded = false;
+    vertices = QVector<QPointF>();
+    bounds = QVector<QRectF>();
+    offsets.resize(1);
+}
+
+void StripItem::Load()
+{
+    if(loaded)
+        return;
+
+    for(int i=0;i<placements.size();++i) {
+        LoadOne(i);
+    }
+    loaded = true;
+    owner->StripLoaded(this);
+}
+
+void StripItem::LoadOne(int index)
+{
+    LB_Polygon2D poly = placements.at(index).Apply(parts->at(placements.at(index).partID));
+
+    QPolygonF target = poly.ToPolygonF();
+    vertices += target;
+    offsets.append(vertices.size());
+    bounds.append(target.boundingRect());
+}
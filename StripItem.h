@@ -0,0 +1,50 @@
+#ifndef STRIPITEM_H
+#define STRIPITEM_H
+
+#include <QGraphicsItem>
+
+#include "nest/LB_Polygon2D.h"
+#include "nest/LB_Placement.h"
+using namespace Shape2D;
+
+class Strip;
+
+// one strip of a large layout drawn as a single item
+// the parts share one vertex buffer which is only built when the strip
+// is painted, so strips that never scroll into view cost one placement
+// record per part
+class StripItem : public QGraphicsItem
+{
+public:
+    StripItem(Strip *owner, const QVector<LB_Polygon2D> *partVec,
+              double stripWid, double stripHei);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+               QWidget *widget = nullptr) override;
+
+    void AddPlacement(const LB_Placement &placement, const QColor &color);
+    int Count() const;
+
+    bool IsLoaded() const;
+    // free the vertex buffer, it is rebuilt on the next paint
+    void Release();
+
+private:
+    void Load();
+    void LoadOne(int index);
+
+    Strip *owner;
+    const QVector<LB_Polygon2D> *parts;
+    QRectF rect;
+
+    QVector<LB_Placement> placements;
+    QVector<QRgb> colors;
+
+    bool loaded = false;
+    QVector<QPointF> vertices;
+    QVector<int> offsets;
+    QVector<QRectF> bounds;
+};
+
+#endif // STRIPITEM_H
@@ -4,9 +4,13 @@
 #include <QTextStream>
 #include <QFile>
 #include <QFileDialog>
+#include <QStatusBar>
 #include <QDebug>
+#include <QtConcurrent>
 
 #include "NestConfigWidget.h"
+#include "nest/LB_NestIO.h"
+#include "nest/LB_RasterExport.h"
 
 #define GENERATE_RESET 100000
 #define MAX_GENERATE_DISTANCE 150
@@ -20,25 +24,32 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->setupUi(this);
 
     qRegisterMetaType<LB_Polygon2D>("LB_Polygon2D");
+    qRegisterMetaType<LB_ValidationReport>("LB_ValidationReport");
 
     stripScene = new Strip;
     nestThread = new LB_NestThread(this);
     configWid = new NestConfigWidget(this);
 
-    connect(nestThread,&LB_NestThread::AddItem,this,[=](LB_Polygon2D poly) {
-        stripScene->AddOneItem(poly);
-        arrangNb++;
-        ui->progressBar_nest->setValue(100*arrangNb/srcPolys.size());
-    });
-    connect(nestThread,&LB_NestThread::AddStrip,stripScene,&Strip::AddOneStrip);
+    connect(nestThread,&LB_NestThread::BaselineReady,this,&MainWindow::onBaselineReady);
+    connect(nestThread,&LB_NestThread::PlacementsReady,this,&MainWindow::onPlacementsReady);
     connect(nestThread,&LB_NestThread::NestEnd,this,&MainWindow::onNestEnd);
     connect(configWid,&QDialog::accepted,this,[=]() {
+        stripScene->SetConfig(configWid->Config());
+        nestThread->SetConfig(configWid->Config());
         ui->label_stripWidth->setText(tr("Strip width:%1").arg(stripScene->getStripWidth()));
         ui->label_stripHeight->setText(tr("Strip height:%1").arg(stripScene->getStripHeight()));
         stripScene->Reset();
+        prefetchNFPs();
+    });
+
+    connect(&exportWatcher,&QFutureWatcher<QString>::finished,this,[=]() {
+        QString error = exportWatcher.result();
+        statusBar()->showMessage(error.isEmpty() ? tr("Saved") : error,5000);
     });
 
     ui->graphicsView_result->setScene(stripScene);
+    // every item sets its own pen and brush
+    ui->graphicsView_result->setOptimizationFlag(QGraphicsView::DontSavePainterState);
     ui->label_stripWidth->setText(tr("Strip width:%1").arg(stripScene->getStripWidth()));
     ui->label_stripHeight->setText(tr("Strip height:%1").arg(stripScene->getStripHeight()));
 }
@@ -63,16 +74,73 @@ void MainWindow::on_action_openFile_triggered()
     }
     ui->label_totalArea->setText(tr("Total area:%1").arg(totalArea));
     setWindowTitle(tr("NFPNest") + '(' + fileName + ')');
+
+    prefetchNFPs();
+}
+
+void MainWindow::prefetchNFPs()
+{
+    // the nest would compute the same NFPs at the same time
+    if(srcPolys.isEmpty() || nestThread->isRunning()) {
+        prefetch.Cancel();
+        return;
+    }
+    prefetch.Start(configWid->Config(),srcPolys,nestThread->Engine()->Cache());
 }
 
 void MainWindow::on_action_saveResult_triggered()
 {
-    QString pixName = QFileDialog::getSaveFileName(this,tr("save"),"","*.bmp *.png *.jpg");
+    if((placements.isEmpty() && !nestThread->isRunning()) || exportWatcher.isRunning())
+        return;
+
+    QString pixName = QFileDialog::getSaveFileName(this,tr("save"),"",
+                                                   tr("Tiled TIFF (*.tif);;One PNG per strip (*.png);;"
+                                                      "SVG per strip (*.svg);;DXF per strip (*.dxf);;JSON per strip (*.json)"));
     if(pixName.isEmpty())
         return;
 
-    QImage img = stripScene->DumpToImage();
-    img.save(pixName);
+    if(pixName.endsWith(".svg",Qt::CaseInsensitive) || pixName.endsWith(".dxf",Qt::CaseInsensitive)
+            || pixName.endsWith(".json",Qt::CaseInsensitive)) {
+        saveVectors(pixName);
+        return;
+    }
+
+    // rendered from the placements in the background, the scene isn't touched
+    QSharedPointer<LB_RasterExport> exporter(new LB_RasterExport(configWid->Config()));
+    QVector<LB_Polygon2D> parts = srcPolys;
+    QVector<LB_Placement> records = placements;
+    bool tiff = pixName.endsWith(".tif",Qt::CaseInsensitive) || pixName.endsWith(".tiff",Qt::CaseInsensitive);
+
+    statusBar()->showMessage(tr("Saving %1 ...").arg(pixName));
+    exportWatcher.setFuture(QtConcurrent::run([=]() {
+        exporter->SetLayout(parts,records);
+        bool ok = tiff ? exporter->ExportTiff(pixName) : exporter->ExportStrips(pixName);
+        return ok ? QString() : exporter->ErrorString();
+    }));
+}
+
+void MainWindow::saveVectors(const QString &fileName)
+{
+    if(!vectorExport.Open(fileName,configWid->Config(),srcPolys)) {
+        statusBar()->showMessage(vectorExport.ErrorString(),5000);
+        return;
+    }
+
+    // the finished strips are written now, the next ones as soon as they are nested
+    vectorExport.Add(placements);
+    if(nestThread->isRunning()) {
+        vectorExporting = true;
+        statusBar()->showMessage(tr("Writing strips to %1 while nesting ...").arg(fileName));
+        return;
+    }
+    finishVectors();
+}
+
+void MainWindow::finishVectors()
+{
+    vectorExporting = false;
+    bool ok = vectorExport.Finish() && vectorExport.ErrorString().isEmpty();
+    statusBar()->showMessage(ok ? tr("Saved %1 strips").arg(vectorExport.StripsWritten()) : vectorExport.ErrorString(),5000);
 }
 
 void MainWindow::on_action_solve_triggered()
@@ -80,14 +148,28 @@ void MainWindow::on_action_solve_triggered()
     if(srcPolys.isEmpty())
         return;
 
+    // the nest goes on from the NFPs prefetched so far
+    nestThread->Engine()->SetRunCache(prefetch.TakeRunCache());
+    prefetch.Cancel();
+
     nestThread->SetPolygons(srcPolys);
+    stripScene->SetParts(srcPolys);
+    placements.clear();
 
-    nestThread->start();
+    nestThread->StartNest();
 }
 
 void MainWindow::on_action_reset_triggered()
 {
+    // the items of a running nest would arrive in the cleared scene
+    prefetch.Cancel();
+    nestThread->StopNest();
+    nestThread->wait();
+
     stripScene->Reset();
+    placements.clear();
+    showingBaseline = false;
+    vectorExporting = false;
     arrangNb = 0;
     totalArea = 0;
     srcPolys.clear();    
@@ -136,13 +218,80 @@ void MainWindow::on_action_resume_triggered()
     nestThread->ResumeNest();
 }
 
+void MainWindow::on_action_stop_triggered()
+{
+    // unlike reset the layout stays, the nest ends with the better of its parts and the baseline
+    nestThread->StopNest();
+}
+
 void MainWindow::on_action_setting_triggered()
 {
     configWid->show();
 }
 
-void MainWindow::onNestEnd()
+void MainWindow::onBaselineReady()
 {
+    // a reset came first
+    if(srcPolys.isEmpty())
+        return;
+
+    // something to look at and to compare with while the nest runs
+    LB_NestEngine *engine = nestThread->Engine();
+    if(placements.isEmpty()) {
+        stripScene->Reset();
+        stripScene->AddPlacements(engine->Baseline());
+        showingBaseline = true;
+    }
+    statusBar()->showMessage(tr("Bounding box layout: %1 strips, nesting ...").arg(engine->BaselineStripNumber()));
+}
+
+void MainWindow::onPlacementsReady()
+{
+    QVector<LB_Placement> batch;
+    nestThread->TakePlacements(batch);
+    if(batch.isEmpty())
+        return;
+
+    if(showingBaseline) {
+        stripScene->Reset();
+        showingBaseline = false;
+    }
+    stripScene->AddPlacements(batch);
+    placements += batch;
+    if(vectorExporting)
+        vectorExport.Add(batch);
+    arrangNb += batch.size();
+    ui->progressBar_nest->setValue(100*arrangNb/srcPolys.size());
+}
+
+void MainWindow::onNestEnd(const LB_ValidationReport &report)
+{
+    // the last placements may not have been announced
+    onPlacementsReady();
+    if(vectorExporting)
+        finishVectors();
+
+    // a stopped nest or one the bounding box layout did better than is replaced by it (not after a reset)
+    LB_NestEngine *engine = nestThread->Engine();
+    if(!srcPolys.isEmpty() && engine->UsesBaseline()) {
+        placements = engine->Baseline();
+        stripScene->Reset();
+        stripScene->AddPlacements(placements);
+        statusBar()->showMessage(engine->IsFinished() ? tr("The bounding box layout uses fewer strips and is kept")
+                                                      : tr("Nest stopped, the bounding box layout is kept"),5000);
+    }
+    // stopped before its first part and no complete baseline either
+    else if(showingBaseline) {
+        stripScene->Reset();
+    }
+    showingBaseline = false;
+
+    // checked by the nest thread
+    if(!placements.isEmpty() && !report.IsValid()) {
+        statusBar()->showMessage(tr("Layout check: %1 overlapping pairs, %2 parts outside their strip")
+                                 .arg(report.overlaps.size()).arg(report.outside.size()));
+    }
+
     int stripNb = stripScene->GetUsedNumber();
     ui->label_stripNb->setText((tr("Used strip number:%1").arg(stripNb)));
     // Statistics
@@ -259,34 +408,7 @@ LB_Polygon2D MainWindow::randomPolygon()
 
 QVector<LB_Polygon2D> MainWindow::loadPolygons(const QString &fileName)
 {
-    QVector<LB_Polygon2D> input;
-
-    QFile polyFile(fileName);
-    QTextStream aStream(&polyFile);
-
-    if(polyFile.open(QIODevice::ReadOnly))
-    {
-        while(!aStream.atEnd())
-        {
-            QString line = aStream.readLine();
-            QStringList points = line.split(";");
-            LB_Polygon2D aPoly;
-            for(int ctr = 0; ctr < points.size(); ++ctr)
-            {
-                QStringList coordinates = points[ctr].split(",");
-                if(coordinates.size() != 2)
-                    continue;
-
-                double x = coordinates[0].toDouble();
-                double y = coordinates[1].toDouble();
-                aPoly.push_back(LB_Coord2D(x,y));
-            }
-            input.push_back(aPoly);
-        }
-    }
-
-    polyFile.close();
-    return input;
+    return NestIO::LoadPolygons(fileName);
 }
 
 void MainWindow::test()
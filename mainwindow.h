@@ -3,8 +3,11 @@
 
 #include <QMainWindow>
 #include <QWheelEvent>
+#include <QFutureWatcher>
 
 #include "nest/LB_NestThread.h"
+#include "nest/LB_VectorExport.h"
+#include "nest/LB_NFPPrefetch.h"
 #include "Strip.h"
 #include "NestConfigWidget.h"
 
@@ -28,9 +31,12 @@ private slots:
     void on_action_test_triggered();
     void on_action_pause_triggered();
     void on_action_resume_triggered();
+    void on_action_stop_triggered();
     void on_action_setting_triggered();
 
-    void onNestEnd();
+    void onBaselineReady();
+    void onPlacementsReady();
+    void onNestEnd(const LB_ValidationReport &report);
 
 protected:
     void wheelEvent(QWheelEvent *event) override;
@@ -43,6 +49,16 @@ private:
     double totalArea;    
 
     QVector<LB_Polygon2D> srcPolys;
+    // everything the nest placed so far, the saved image is rendered from it
+    QVector<LB_Placement> placements;
+    // the scene shows the bounding box layout until the nest places its first parts
+    bool showingBaseline = false;
+    QFutureWatcher<QString> exportWatcher;
+    // vector files written strip by strip while the nest runs
+    LB_VectorExport vectorExport;
+    bool vectorExporting = false;
+    // NFPs of the loaded parts computed while waiting for solve
+    LB_NFPPrefetch prefetch;
 
     Strip *stripScene;
     LB_NestThread *nestThread;
@@ -52,6 +68,10 @@ private:
 
     QVector<LB_Polygon2D> loadPolygons(const QString &fileName);
 
+    void saveVectors(const QString &fileName);
+    void finishVectors();
+    void prefetchNFPs();
+
     void test();
 };
 
@@ -0,0 +1,262 @@
+#include "LB_AABBTree.h"
+
+#include <algorithm>
+
+namespace {
+
+LB_Rect2D Union(const LB_Rect2D &a, const LB_Rect2D &b)
+{
+    double x0 = std::min(a.X(),b.X());
+    double y0 = std::min(a.Y(),b.Y());
+    double x1 = std::max(a.X()+a.Width(),b.X()+b.Width());
+    double y1 = std::max(a.Y()+a.Height(),b.Y()+b.Height());
+    return LB_Rect2D(x0,y0,x1-x0,y1-y0);
+}
+
+double Perimeter(const LB_Rect2D &a)
+{
+    return 2*(a.Width()+a.Height());
+}
+
+bool Overlap(const LB_Rect2D &a, const LB_Rect2D &b)
+{
+    return a.X() < b.X() + b.Width() && b.X() < a.X() + a.Width()
+            && a.Y() < b.Y() + b.Height() && b.Y() < a.Y() + a.Height();
+}
+
+}
+
+LB_AABBTree::LB_AABBTree()
+{
+}
+
+int LB_AABBTree::Allocate()
+{
+    if(freeList == -1) {
+        nodes.append(Node());
+        return nodes.size()-1;
+    }
+    int index = freeList;
+    freeList = nodes[index].left;
+    nodes[index] = Node();
+    return index;
+}
+
+void LB_AABBTree::Free(int index)
+{
+    nodes[index] = Node();
+    nodes[index].height = -1;
+    nodes[index].left = freeList;
+    freeList = index;
+}
+
+int LB_AABBTree::Insert(const LB_Rect2D &box, int userID)
+{
+    int leaf = Allocate();
+    nodes[leaf].box = box;
+    nodes[leaf].userID = userID;
+    InsertLeaf(leaf);
+    count++;
+    return leaf;
+}
+
+void LB_AABBTree::Remove(int proxy)
+{
+    RemoveLeaf(proxy);
+    Free(proxy);
+    count--;
+}
+
+void LB_AABBTree::Update(int proxy, const LB_Rect2D &box)
+{
+    RemoveLeaf(proxy);
+    nodes[proxy].box = box;
+    InsertLeaf(proxy);
+}
+
+void LB_AABBTree::Clear()
+{
+    nodes.clear();
+    root = -1;
+    freeList = -1;
+    count = 0;
+}
+
+void LB_AABBTree::InsertLeaf(int leaf)
+{
+    if(root == -1) {
+        root = leaf;
+        nodes[root].parent = -1;
+        return;
+    }
+
+    // walk down to the sibling with the cheapest growth of the perimeters
+    const LB_Rect2D box = nodes[leaf].box;
+    int index = root;
+    while(!nodes[index].IsLeaf()) {
+        const int left = nodes[index].left;
+        const int right = nodes[index].right;
+
+        const double area = Perimeter(nodes[index].box);
+        const double combined = Perimeter(Union(nodes[index].box,box));
+        // cost of a new parent here, and the least cost pushed down to the children
+        const double cost = 2*combined;
+        const double inherit = 2*(combined-area);
+
+        double costLeft = Perimeter(Union(box,nodes[left].box)) + inherit;
+        if(!nodes[left].IsLeaf())
+            costLeft -= Perimeter(nodes[left].box);
+        double costRight = Perimeter(Union(box,nodes[right].box)) + inherit;
+        if(!nodes[right].IsLeaf())
+            costRight -= Perimeter(nodes[right].box);
+
+        if(cost < costLeft && cost < costRight)
+            break;
+        index = costLeft < costRight ? left : right;
+    }
+
+    // a new parent for the sibling and the leaf
+    const int sibling = index;
+    const int oldParent = nodes[sibling].parent;
+    const int newParent = Allocate();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = Union(box,nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if(oldParent == -1) {
+        root = newParent;
+    }
+    else if(nodes[oldParent].left == sibling) {
+        nodes[oldParent].left = newParent;
+    }
+    else {
+        nodes[oldParent].right = newParent;
+    }
+
+    Refit(nodes[leaf].parent);
+}
+
+void LB_AABBTree::RemoveLeaf(int leaf)
+{
+    if(leaf == root) {
+        root = -1;
+        return;
+    }
+
+    const int parent = nodes[leaf].parent;
+    const int grandParent = nodes[parent].parent;
+    const int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    if(grandParent == -1) {
+        root = sibling;
+        nodes[sibling].parent = -1;
+        Free(parent);
+        return;
+    }
+
+    // the sibling takes the place of the parent
+    if(nodes[grandParent].left == parent) {
+        nodes[grandParent].left = sibling;
+    }
+    else {
+        nodes[grandParent].right = sibling;
+    }
+    nodes[sibling].parent = grandParent;
+    Free(parent);
+
+    Refit(grandParent);
+}
+
+void LB_AABBTree::Refit(int index)
+{
+    while(index != -1) {
+        index = Balance(index);
+
+        const int left = nodes[index].left;
+        const int right = nodes[index].right;
+        nodes[index].height = 1 + std::max(nodes[left].height,nodes[right].height);
+        nodes[index].box = Union(nodes[left].box,nodes[right].box);
+
+        index = nodes[index].parent;
+    }
+}
+
+int LB_AABBTree::Balance(int a)
+{
+    // rotates the higher child up when the heights differ by more than one
+    // returns the node now at the place of a
+    if(nodes[a].IsLeaf() || nodes[a].height < 2)
+        return a;
+
+    const int b = nodes[a].left;
+    const int c = nodes[a].right;
+    const int balance = nodes[c].height - nodes[b].height;
+    if(balance >= -1 && balance <= 1)
+        return a;
+
+    // up is the higher child, side the other one
+    const int up = balance > 1 ? c : b;
+    const int side = balance > 1 ? b : c;
+    const int f = nodes[up].left;
+    const int g = nodes[up].right;
+
+    // up replaces a
+    nodes[up].left = a;
+    nodes[up].parent = nodes[a].parent;
+    nodes[a].parent = up;
+    if(nodes[up].parent == -1) {
+        root = up;
+    }
+    else if(nodes[nodes[up].parent].left == a) {
+        nodes[nodes[up].parent].left = up;
+    }
+    else {
+        nodes[nodes[up].parent].right = up;
+    }
+
+    // the higher grandchild stays under up, the lower one goes to a
+    const int keep = nodes[f].height > nodes[g].height ? f : g;
+    const int give = keep == f ? g : f;
+    nodes[up].right = keep;
+    nodes[keep].parent = up;
+    if(balance > 1) {
+        nodes[a].right = give;
+    }
+    else {
+        nodes[a].left = give;
+    }
+    nodes[give].parent = a;
+
+    nodes[a].box = Union(nodes[side].box,nodes[give].box);
+    nodes[a].height = 1 + std::max(nodes[side].height,nodes[give].height);
+    nodes[up].box = Union(nodes[a].box,nodes[keep].box);
+    nodes[up].height = 1 + std::max(nodes[a].height,nodes[keep].height);
+    return up;
+}
+
+void LB_AABBTree::Query(const LB_Rect2D &box, QVector<int> &result) const
+{
+    if(root == -1)
+        return;
+
+    QVector<int> stack;
+    stack.append(root);
+    while(!stack.isEmpty()) {
+        const int index = stack.takeLast();
+        const Node &aNode = nodes[index];
+        if(!Overlap(aNode.box,box))
+            continue;
+
+        if(aNode.IsLeaf()) {
+            result.append(aNode.userID);
+        }
+        else {
+            stack.append(aNode.left);
+            stack.append(aNode.right);
+        }
+    }
+}
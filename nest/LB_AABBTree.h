@@ -0,0 +1,64 @@
+#ifndef LB_AABBTREE_H
+#define LB_AABBTREE_H
+
+#include <QVector>
+
+#include "LB_Rect2D.h"
+using namespace Shape2D;
+
+// dynamic bounding volume tree over the boxes of placed parts
+// insert/remove/update are O(log n) on average, queries only visit the branches
+// whose box overlaps, so exact geometry is only run against nearby parts
+class LB_AABBTree
+{
+public:
+    LB_AABBTree();
+
+    // returns a proxy for Remove()/Update(), userID is given back by the queries
+    int Insert(const LB_Rect2D &box, int userID);
+    void Remove(int proxy);
+    void Update(int proxy, const LB_Rect2D &box);
+    void Clear();
+
+    int Size() const {
+        return count;
+    }
+    int UserID(int proxy) const {
+        return nodes[proxy].userID;
+    }
+    const LB_Rect2D &Box(int proxy) const {
+        return nodes[proxy].box;
+    }
+
+    // appends the userID of every box overlapping box (touching doesn't count)
+    void Query(const LB_Rect2D &box, QVector<int> &result) const;
+
+private:
+    struct Node {
+        LB_Rect2D box;
+        int userID = -1;
+        int parent = -1;
+        // a leaf has no children, left is the next free node when the node is free
+        int left = -1;
+        int right = -1;
+        int height = 0;
+
+        bool IsLeaf() const {
+            return right == -1;
+        }
+    };
+
+    int Allocate();
+    void Free(int index);
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    void Refit(int index);
+    int Balance(int index);
+
+    QVector<Node> nodes;
+    int root = -1;
+    int freeList = -1;
+    int count = 0;
+};
+
+#endif // LB_AABBTREE_H
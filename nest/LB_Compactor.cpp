@@ -0,0 +1,134 @@
+#include "LB_Compactor.h"
+#include "LB_NFPHandle.h"
+
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <algorithm>
+
+using namespace NFPHandle;
+
+namespace {
+
+// shorter slides are not worth another pass
+const double MIN_MOVE = 1e-2;
+
+LB_Rect2D BoxOf(const LB_Polygon2D &poly)
+{
+    return LB_Rect2D(poly.X(),poly.Y(),poly.Width(),poly.Height());
+}
+
+}
+
+LB_Compactor::LB_Compactor(double stripWid, double stripHei) :
+    stripWid(stripWid),
+    stripHei(stripHei)
+{
+}
+
+int LB_Compactor::Compact(QVector<LB_Polygon2D> &polys, int budgetMs, LB_NestControl *control)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const LB_Coord2D left(-1,0);
+    const LB_Coord2D down(0,-1);
+
+    tree.Clear();
+    proxies.resize(polys.size());
+    for(int i=0;i<polys.size();++i) {
+        proxies[i] = tree.Insert(BoxOf(polys[i]),i);
+    }
+
+    int moves = 0;
+    while(timer.elapsed() < budgetMs) {
+        if(control && control->IsCanceled())
+            break;
+
+        int passMoves = Pass(polys,left);
+        passMoves += Pass(polys,down);
+        moves += passMoves;
+        if(passMoves == 0)
+            break;
+    }
+    return moves;
+}
+
+LB_Rect2D LB_Compactor::Sweep(const LB_Polygon2D &poly, const LB_Coord2D &direction) const
+{
+    if(direction.X() < 0)
+        return LB_Rect2D(0,poly.Y(),poly.X()+poly.Width(),poly.Height());
+    return LB_Rect2D(poly.X(),0,poly.Width(),poly.Y()+poly.Height());
+}
+
+double LB_Compactor::SlideDistance(const QVector<LB_Polygon2D> &polys, int index, const LB_Coord2D &direction) const
+{
+    const LB_Polygon2D &B = polys[index];
+
+    // the wall first, then every part in the way
+    double distance = direction.X() < 0 ? B.X() : B.Y();
+    QVector<int> candidates;
+    tree.Query(Sweep(B,direction),candidates);
+    foreach(int other,candidates) {
+        if(other == index)
+            continue;
+
+        double d = PolygonSlideDistance(polys[other],B,direction,true);
+        if(d != DIM_MAX && d < distance)
+            distance = d;
+    }
+    return qMax(0.0,distance);
+}
+
+int LB_Compactor::Pass(QVector<LB_Polygon2D> &polys, const LB_Coord2D &direction)
+{
+    // nearest to the wall first, they make room for the others
+    QVector<int> waiting(polys.size());
+    for(int i=0;i<polys.size();++i) {
+        waiting[i] = i;
+    }
+    std::sort(waiting.begin(),waiting.end(),[&](int a, int b) {
+        return direction.X() < 0 ? polys[a].X() < polys[b].X() : polys[a].Y() < polys[b].Y();
+    });
+
+    int moves = 0;
+    QVector<int> batch, next, hits;
+    LB_AABBTree batchSweeps;
+    QVector<double> distances;
+    while(!waiting.isEmpty()) {
+        // parts whose swept areas are apart can't hit each other, they move together
+        batch.clear();
+        batchSweeps.Clear();
+        next.clear();
+        foreach(int index,waiting) {
+            const LB_Rect2D sweep = Sweep(polys[index],direction);
+            hits.clear();
+            batchSweeps.Query(sweep,hits);
+            if(hits.isEmpty()) {
+                batch.append(index);
+                batchSweeps.Insert(sweep,index);
+            }
+            else {
+                next.append(index);
+            }
+        }
+
+        distances.resize(batch.size());
+        QVector<int> tasks(batch.size());
+        for(int i=0;i<tasks.size();++i) {
+            tasks[i] = i;
+        }
+        QtConcurrent::blockingMap(tasks,[&](int i) {
+            distances[i] = SlideDistance(polys,batch[i],direction);
+        });
+
+        for(int i=0;i<batch.size();++i) {
+            if(distances[i] < MIN_MOVE)
+                continue;
+            polys[batch[i]].Translate(direction.X()*distances[i],direction.Y()*distances[i]);
+            tree.Update(proxies[batch[i]],BoxOf(polys[batch[i]]));
+            moves++;
+        }
+        waiting.swap(next);
+    }
+    return moves;
+}
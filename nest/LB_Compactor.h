@@ -0,0 +1,39 @@
+#ifndef LB_COMPACTOR_H
+#define LB_COMPACTOR_H
+
+#include <QVector>
+
+#include "LB_Polygon2D.h"
+#include "LB_NestControl.h"
+#include "LB_AABBTree.h"
+using namespace Shape2D;
+
+// pushes the placed polygons of one strip left and down as far as they can slide,
+// which gives back strip length without another nest
+// the neighbours a part can hit are found in an AABB tree of the strip, and parts whose
+// swept areas don't overlap are moved in parallel
+class LB_Compactor
+{
+public:
+    LB_Compactor(double stripWid, double stripHei);
+
+    // repeats until nothing moves, budgetMs is spent or the control is canceled
+    // returns the number of moves made
+    int Compact(QVector<LB_Polygon2D> &polys, int budgetMs, LB_NestControl *control = nullptr);
+
+private:
+    // one pass over every part in direction (-1,0) or (0,-1), returns the moves
+    int Pass(QVector<LB_Polygon2D> &polys, const LB_Coord2D &direction);
+    // the area a part covers while it slides to the wall
+    LB_Rect2D Sweep(const LB_Polygon2D &poly, const LB_Coord2D &direction) const;
+    double SlideDistance(const QVector<LB_Polygon2D> &polys, int index, const LB_Coord2D &direction) const;
+
+    double stripWid;
+    double stripHei;
+
+    // the bounds of the parts, proxies[i] is the node of polys[i]
+    LB_AABBTree tree;
+    QVector<int> proxies;
+};
+
+#endif // LB_COMPACTOR_H
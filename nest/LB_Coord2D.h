@@ -89,6 +89,13 @@ public:
         return dx1*dy2 - dy1*dx2;
     }
 
+    // how far off the line AB OnSegment() still accepts a point, its cross product is not
+    // normalized; a box around a short edge has to be grown by at least this much
+    static double OnSegmentReach(const LB_Coord2D &A, const LB_Coord2D &B) {
+        double len = sqrt((B.x - A.x)*(B.x - A.x) + (B.y - A.y)*(B.y - A.y));
+        return FLOAT_TOL / std::fmax(len, FLOAT_TOL);
+    }
+
     static bool OnSegment(const LB_Coord2D &A,const LB_Coord2D &B, const LB_Coord2D &p) {
         // vertical line
         if(FuzzyEqual(A.x, B.x) && FuzzyEqual(p.x, A.x)){
@@ -0,0 +1,245 @@
+#include "LB_LayoutValidator.h"
+#include "LB_AABBTree.h"
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QPair>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+LB_Rect2D BoxOf(const LB_Polygon2D &poly)
+{
+    return LB_Rect2D(poly.X(),poly.Y(),poly.Width(),poly.Height());
+}
+
+// the polygons may or may not repeat the first point at the end
+int VertexCount(const LB_Polygon2D &poly)
+{
+    int n = poly.size();
+    if(n > 1 && poly.first() == poly.last())
+        n--;
+    return n;
+}
+
+double SegmentPointDistance(const LB_Coord2D &p, const LB_Coord2D &s1, const LB_Coord2D &s2)
+{
+    LB_Coord2D d = s2 - s1;
+    double len2 = d.Dot(d);
+    double t = len2 > 0 ? qBound(0.0,(p - s1).Dot(d)/len2,1.0) : 0;
+    LB_Coord2D q = s1 + d*t;
+    return std::sqrt((p.X()-q.X())*(p.X()-q.X()) + (p.Y()-q.Y())*(p.Y()-q.Y()));
+}
+
+double BoundaryDistance(const LB_Coord2D &p, const LB_Polygon2D &poly)
+{
+    const int n = VertexCount(poly);
+    double distance = DIM_MAX;
+    for(int i=0;i<n;++i) {
+        distance = qMin(distance,SegmentPointDistance(p,poly[i],poly[(i+1)%n]));
+    }
+    return distance;
+}
+
+// distance of p inside poly, 0 if it is outside or on the boundary
+double Depth(const LB_Coord2D &p, const LB_PreparedPolygon &poly, double tolerance)
+{
+    if(poly.ContainPoint(p) != PointInPolygon::INSIDE)
+        return 0;
+    double distance = BoundaryDistance(p,poly.Polygon());
+    return distance > tolerance ? distance : 0;
+}
+
+// the segments cross each other, each one has its ends more than tolerance away from the other's line
+bool Cross(const LB_Coord2D &a1, const LB_Coord2D &a2, const LB_Coord2D &b1, const LB_Coord2D &b2, double tolerance)
+{
+    LB_Coord2D da = a2 - a1;
+    LB_Coord2D db = b2 - b1;
+    double lenA = std::sqrt(da.Dot(da));
+    double lenB = std::sqrt(db.Dot(db));
+    if(lenA <= tolerance || lenB <= tolerance)
+        return false;
+
+    double s1 = db.Cross(a1 - b1)/lenB;
+    double s2 = db.Cross(a2 - b1)/lenB;
+    double t1 = da.Cross(b1 - a1)/lenA;
+    double t2 = da.Cross(b2 - a1)/lenA;
+    return ((s1 > tolerance && s2 < -tolerance) || (s1 < -tolerance && s2 > tolerance))
+            && ((t1 > tolerance && t2 < -tolerance) || (t1 < -tolerance && t2 > tolerance));
+}
+
+// smallest overlap of the projections over the edge normals of both hulls, 0 if an axis separates them
+double HullOverlap(const QVector<LB_Coord2D> &hullA, const QVector<LB_Coord2D> &hullB)
+{
+    double overlap = DIM_MAX;
+    for(int pass=0;pass<2;++pass) {
+        const QVector<LB_Coord2D> &hull = pass == 0 ? hullA : hullB;
+        for(int i=0;i<hull.size();++i) {
+            LB_Coord2D edge = hull[(i+1)%hull.size()] - hull[i];
+            if(edge.Dot(edge) == 0)
+                continue;
+            LB_Coord2D axis = LB_Coord2D(-edge.Y(),edge.X()).Normalized();
+
+            double minA = DIM_MAX, maxA = -DIM_MAX;
+            foreach(const LB_Coord2D &p,hullA) {
+                minA = qMin(minA,p.Dot(axis));
+                maxA = qMax(maxA,p.Dot(axis));
+            }
+            double minB = DIM_MAX, maxB = -DIM_MAX;
+            foreach(const LB_Coord2D &p,hullB) {
+                minB = qMin(minB,p.Dot(axis));
+                maxB = qMax(maxB,p.Dot(axis));
+            }
+            overlap = qMin(overlap,qMin(maxA,maxB) - qMax(minA,minB));
+            if(overlap <= 0)
+                return 0;
+        }
+    }
+    return overlap == DIM_MAX ? 0 : overlap;
+}
+
+}
+
+LB_LayoutValidator::LB_LayoutValidator(double stripWid, double stripHei, double tolerance) :
+    stripWid(stripWid),
+    stripHei(stripHei),
+    tolerance(tolerance)
+{
+}
+
+bool LB_LayoutValidator::Outside(const LB_Polygon2D &poly) const
+{
+    return poly.X() < -tolerance || poly.Y() < -tolerance
+            || poly.X()+poly.Width() > stripWid+tolerance
+            || poly.Y()+poly.Height() > stripHei+tolerance;
+}
+
+bool LB_LayoutValidator::Overlap(const LB_Polygon2D &a, const LB_Polygon2D &b, double &depth) const
+{
+    return Overlap(LB_PreparedPolygon(a),LB_PreparedPolygon(b),depth);
+}
+
+bool LB_LayoutValidator::Overlap(const LB_PreparedPolygon &preparedA, const LB_PreparedPolygon &preparedB, double &depth) const
+{
+    const LB_Polygon2D &a = preparedA.Polygon();
+    const LB_Polygon2D &b = preparedB.Polygon();
+    depth = 0;
+    const int n = VertexCount(a);
+    const int m = VertexCount(b);
+    if(n < 3 || m < 3)
+        return false;
+
+    // a vertex of one inside the other
+    for(int i=0;i<n;++i) {
+        depth = qMax(depth,Depth(a[i],preparedB,tolerance));
+    }
+    for(int j=0;j<m;++j) {
+        depth = qMax(depth,Depth(b[j],preparedA,tolerance));
+    }
+    if(depth > 0)
+        return true;
+
+    // crossing edges
+    bool overlap = false;
+    for(int i=0;i<n && !overlap;++i) {
+        for(int j=0;j<m && !overlap;++j) {
+            overlap = Cross(a[i],a[(i+1)%n],b[j],b[(j+1)%m],tolerance);
+        }
+    }
+
+    // parts lying on each other with every vertex on the other's boundary:
+    // a point just inside a, next to an edge, is then inside b
+    if(!overlap) {
+        const double side = a.IsAntiClockWise() ? 1 : -1;
+        for(int i=0;i<n && !overlap;++i) {
+            LB_Coord2D edge = a[(i+1)%n] - a[i];
+            if(std::sqrt(edge.Dot(edge)) <= 4*tolerance)
+                continue;
+            LB_Coord2D inward = LB_Coord2D(-edge.Y(),edge.X()).Normalized()*(side*2*tolerance);
+            overlap = Depth((a[i] + a[(i+1)%n])*0.5 + inward,preparedB,tolerance) > 0;
+        }
+    }
+
+    if(overlap)
+        depth = qMax(HullOverlap(a.ConvexHull(),b.ConvexHull()),tolerance);
+    return overlap;
+}
+
+LB_ValidationReport LB_LayoutValidator::Validate(const QVector<LB_Polygon2D> &placed) const
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    LB_ValidationReport report;
+
+    QMap<int,QVector<int> > strips;
+    for(int i=0;i<placed.size();++i) {
+        if(Outside(placed[i]))
+            report.outside.append(i);
+        strips[placed[i].ID()].append(i);
+    }
+
+    // broad phase, one tree per strip, every pair whose boxes overlap once
+    QVector<QPair<int,int> > pairs;
+    LB_AABBTree tree;
+    QVector<int> hits;
+    for(auto it=strips.constBegin();it!=strips.constEnd();++it) {
+        tree.Clear();
+        foreach(int index,it.value()) {
+            tree.Insert(BoxOf(placed[index]),index);
+        }
+        foreach(int index,it.value()) {
+            hits.clear();
+            tree.Query(BoxOf(placed[index]),hits);
+            foreach(int other,hits) {
+                if(other > index)
+                    pairs.append(qMakePair(index,other));
+            }
+        }
+    }
+    report.checkedPairs = pairs.size();
+
+    // every part in a pair is prepared once for all its pairs,
+    // with its cached properties filled before the pairs share it
+    QVector<int> tasks;
+    QVector<LB_PreparedPolygon> prepared(placed.size());
+    QVector<bool> inPair(placed.size(),false);
+    for(int i=0;i<pairs.size();++i) {
+        inPair[pairs[i].first] = true;
+        inPair[pairs[i].second] = true;
+    }
+    for(int i=0;i<placed.size();++i) {
+        if(inPair[i])
+            tasks.append(i);
+    }
+    QtConcurrent::blockingMap(tasks,[&](int i) {
+        prepared[i] = LB_PreparedPolygon(placed[i]);
+        prepared[i].Polygon().UpdateCache();
+    });
+
+    // exact tests, every pair writes its own slot
+    QVector<double> depths(pairs.size());
+    tasks.resize(pairs.size());
+    for(int i=0;i<tasks.size();++i) {
+        tasks[i] = i;
+    }
+    QtConcurrent::blockingMap(tasks,[&](int i) {
+        double depth = 0;
+        depths[i] = Overlap(prepared[pairs[i].first],prepared[pairs[i].second],depth) ? depth : -1;
+    });
+
+    for(int i=0;i<pairs.size();++i) {
+        if(depths[i] < 0)
+            continue;
+        LB_Overlap anOverlap;
+        anOverlap.stripID = placed[pairs[i].first].ID();
+        anOverlap.a = pairs[i].first;
+        anOverlap.b = pairs[i].second;
+        anOverlap.depth = depths[i];
+        report.overlaps.append(anOverlap);
+    }
+
+    report.elapsedMs = timer.elapsed();
+    return report;
+}
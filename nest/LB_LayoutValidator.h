@@ -0,0 +1,58 @@
+#ifndef LB_LAYOUTVALIDATOR_H
+#define LB_LAYOUTVALIDATOR_H
+
+#include <QVector>
+
+#include "LB_PreparedPolygon.h"
+using namespace Shape2D;
+
+// two placed parts which overlap, a and b are indexes into the validated polygons
+struct LB_Overlap
+{
+    int stripID = -1;
+    int a = -1;
+    int b = -1;
+    // how far the parts reach into each other (see LB_LayoutValidator)
+    double depth = 0;
+};
+
+struct LB_ValidationReport
+{
+    QVector<LB_Overlap> overlaps;
+    // indexes of the parts which leave their strip
+    QVector<int> outside;
+    int checkedPairs = 0;
+    qint64 elapsedMs = 0;
+
+    bool IsValid() const {
+        return overlaps.isEmpty() && outside.isEmpty();
+    }
+};
+
+// checks a finished layout: no two parts on a strip overlap and every part stays in its strip
+// only the pairs whose boxes overlap (found in an AABB tree per strip) get the exact test,
+// and those tests run in parallel
+// touching parts are fine, anything within tolerance counts as touching
+class LB_LayoutValidator
+{
+public:
+    LB_LayoutValidator(double stripWid, double stripHei, double tolerance = 1e-6);
+
+    // placed polygons as the engine makes them, ID() is the strip
+    LB_ValidationReport Validate(const QVector<LB_Polygon2D> &placed) const;
+
+    // true if a and b share more than a boundary, depth is then set to
+    // the deepest vertex of one inside the other, or if no vertex is inside (crossing parts)
+    // the overlap of their convex hulls along the best separating axis
+    bool Overlap(const LB_Polygon2D &a, const LB_Polygon2D &b, double &depth) const;
+
+private:
+    bool Outside(const LB_Polygon2D &poly) const;
+    bool Overlap(const LB_PreparedPolygon &a, const LB_PreparedPolygon &b, double &depth) const;
+
+    double stripWid;
+    double stripHei;
+    double tolerance;
+};
+
+#endif // LB_LAYOUTVALIDATOR_H
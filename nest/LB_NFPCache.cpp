@@ -0,0 +1,202 @@
+#include "LB_NFPCache.h"
+
+#include <QPair>
+#include <algorithm>
+
+namespace {
+
+// about 130 MB of coordinates
+const qint64 DEFAULT_CAPACITY = 8000000;
+
+// p -> -p, a point reflection keeps the winding
+void Reflect(LB_Polygon2D &poly)
+{
+    for(int i=0;i<poly.size();++i) {
+        poly.SetPoint(i,LB_Coord2D(-poly[i].X(),-poly[i].Y()));
+    }
+}
+
+}
+
+namespace NFPHandle {
+
+LB_NFPCache::LB_NFPCache() :
+    capacity(DEFAULT_CAPACITY)
+{
+}
+
+bool LB_NFPCache::Find(const LB_Polygon2D &A, const LB_Polygon2D &B, bool inside, bool searchEdges,
+                       QVector<LB_Polygon2D> &nfp) const
+{
+    if(A.isEmpty() || B.isEmpty())
+        return false;
+
+    bool reversed = false;
+    QByteArray key = MakeKey(A,B,inside,searchEdges,reversed);
+
+    QReadLocker locker(&lock);
+    auto it = table.constFind(key);
+    if(it != table.constEnd()) {
+        nfp = it->nfp;
+        it->used.storeRelaxed(useClock.fetchAndAddRelaxed(1));
+        locker.unlock();
+    }
+    else {
+        locker.unlock();
+        // an NFP of an earlier run is kept in memory from now on
+        if(!store || !store->Find(key,nfp)) {
+            misses.fetchAndAddRelaxed(1);
+            return false;
+        }
+        storeHits.fetchAndAddRelaxed(1);
+        QWriteLocker writeLocker(&lock);
+        Add(key,nfp);
+    }
+
+    // stored relative to the reference point of A,
+    // or for (B,A) as the places of A[0] relative to B[0], which are A[0] minus the places of B[0]
+    hits.fetchAndAddRelaxed(1);
+    if(reversed)
+        reflections.fetchAndAddRelaxed(1);
+
+    for(int i=0;i<nfp.size();++i) {
+        if(reversed)
+            Reflect(nfp[i]);
+        nfp[i].Translate(A[0].X(),A[0].Y());
+    }
+    return true;
+}
+
+void LB_NFPCache::Insert(const LB_Polygon2D &A, const LB_Polygon2D &B, bool inside, bool searchEdges,
+                         const QVector<LB_Polygon2D> &nfp)
+{
+    if(A.isEmpty() || B.isEmpty())
+        return;
+
+    bool reversed = false;
+    QByteArray key = MakeKey(A,B,inside,searchEdges,reversed);
+
+    QVector<LB_Polygon2D> relative = nfp;
+    for(int i=0;i<relative.size();++i) {
+        relative[i].Translate(-A[0].X(),-A[0].Y());
+        if(reversed)
+            Reflect(relative[i]);
+    }
+
+    QWriteLocker locker(&lock);
+    Add(key,relative);
+    locker.unlock();
+
+    if(store)
+        store->Append(key,relative);
+}
+
+void LB_NFPCache::Add(const QByteArray &key, const QVector<LB_Polygon2D> &nfp) const
+{
+    Entry &entry = table[key];
+    points -= entry.points;
+    entry.nfp = nfp;
+    // an empty NFP costs its entry too
+    entry.points = 1;
+    foreach(const LB_Polygon2D &aPoly,nfp) {
+        entry.points += aPoly.size();
+    }
+    entry.used.storeRelaxed(useClock.fetchAndAddRelaxed(1));
+    points += entry.points;
+
+    if(capacity > 0 && points > capacity)
+        Evict();
+}
+
+void LB_NFPCache::Evict() const
+{
+    // down to 3/4 at once, so not every insert sorts the table
+    QVector<QPair<quint64, QByteArray>> ages;
+    ages.reserve(table.size());
+    for(auto it = table.constBegin(); it != table.constEnd(); ++it) {
+        ages.append(qMakePair(it->used.loadRelaxed(),it.key()));
+    }
+    std::sort(ages.begin(),ages.end(),[](const QPair<quint64, QByteArray> &a, const QPair<quint64, QByteArray> &b) {
+        return a.first < b.first;
+    });
+
+    const qint64 target = capacity/4*3;
+    for(int i=0;i<ages.size() && points > target;++i) {
+        auto it = table.find(ages[i].second);
+        points -= it->points;
+        table.erase(it);
+        evictions.fetchAndAddRelaxed(1);
+    }
+}
+
+int LB_NFPCache::Size() const
+{
+    QReadLocker locker(&lock);
+    return table.size();
+}
+
+qint64 LB_NFPCache::Points() const
+{
+    QReadLocker locker(&lock);
+    return points;
+}
+
+qint64 LB_NFPCache::Capacity() const
+{
+    QReadLocker locker(&lock);
+    return capacity;
+}
+
+void LB_NFPCache::SetCapacity(qint64 aCapacity)
+{
+    QWriteLocker locker(&lock);
+    capacity = aCapacity;
+    if(capacity > 0 && points > capacity)
+        Evict();
+}
+
+void LB_NFPCache::Clear()
+{
+    QWriteLocker locker(&lock);
+    table.clear();
+    points = 0;
+    hits.storeRelaxed(0);
+    misses.storeRelaxed(0);
+    reflections.storeRelaxed(0);
+    storeHits.storeRelaxed(0);
+    evictions.storeRelaxed(0);
+}
+
+QByteArray LB_NFPCache::MakeKey(const LB_Polygon2D &A, const LB_Polygon2D &B, bool inside, bool searchEdges,
+                                bool &reversed)
+{
+    // the NFP only depends on the location of A, B is moved to its start point anyway
+    QByteArray shapeA = ShapeKey(A);
+    QByteArray shapeB = ShapeKey(B);
+    // an inner NFP has no such symmetry
+    reversed = !inside && shapeB < shapeA;
+
+    const int flags = (inside ? 1 : 0) | (searchEdges ? 2 : 0);
+    QByteArray key;
+    key.reserve(int(sizeof(int)) + shapeA.size() + shapeB.size());
+    key.append(reinterpret_cast<const char *>(&flags),int(sizeof(flags)));
+    key.append(reversed ? shapeB : shapeA);
+    key.append(reversed ? shapeA : shapeB);
+    return key;
+}
+
+QByteArray LB_NFPCache::ShapeKey(const LB_Polygon2D &poly)
+{
+    QByteArray key;
+    key.reserve(int(sizeof(int)) + int(sizeof(double))*2*poly.size());
+
+    const int size = poly.size();
+    key.append(reinterpret_cast<const char *>(&size),int(sizeof(size)));
+    for(int i=0;i<poly.size();++i) {
+        const double rel[2] = {poly[i].X()-poly[0].X(), poly[i].Y()-poly[0].Y()};
+        key.append(reinterpret_cast<const char *>(rel),int(sizeof(rel)));
+    }
+    return key;
+}
+
+}
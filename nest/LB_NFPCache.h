@@ -0,0 +1,105 @@
+#ifndef LB_NFPCACHE_H
+#define LB_NFPCACHE_H
+
+#include <QHash>
+#include <QByteArray>
+#include <QReadWriteLock>
+#include <QAtomicInt>
+
+#include <QSharedPointer>
+
+#include "LB_Polygon2D.h"
+#include "LB_NFPStore.h"
+using namespace Shape2D;
+
+namespace NFPHandle {
+
+// thread-safe store of computed NFPs
+// entries are keyed by the shapes of A and B, independent of where they are located,
+// so the same pair met again at another place is answered by a translation
+// an outer NFP of B around A is the point reflection of the one of A around B, so it is stored
+// once for the pair in a canonical order and the reversed pair is answered by reflecting it
+// the entries in memory are bounded by their points, the least recently used go first
+class LB_NFPCache
+{
+public:
+    LB_NFPCache();
+
+    // returns true if the pair is known, nfp is translated to the current location of A
+    bool Find(const LB_Polygon2D &A, const LB_Polygon2D &B, bool inside, bool searchEdges,
+              QVector<LB_Polygon2D> &nfp) const;
+    void Insert(const LB_Polygon2D &A, const LB_Polygon2D &B, bool inside, bool searchEdges,
+                const QVector<LB_Polygon2D> &nfp);
+
+    int Size() const;
+    // the entries in memory, the store keeps its own
+    void Clear();
+
+    // points of all NFPs in memory, each entry counts one more
+    qint64 Points() const;
+    // above capacity the least recently used entries are dropped down to 3/4 of it, 0 keeps all
+    qint64 Capacity() const;
+    void SetCapacity(qint64 points);
+    int Evictions() const {
+        return evictions.loadRelaxed();
+    }
+
+    // a store on disk behind the cache: a miss is looked up there and an insert is added to it
+    // set before the cache is used, it may be shared with other caches
+    QSharedPointer<LB_NFPStore> Store() const {
+        return store;
+    }
+    void SetStore(const QSharedPointer<LB_NFPStore> &aStore) {
+        store = aStore;
+    }
+
+    // lookup statistics, since construction or the last Clear()
+    int Hits() const {
+        return hits.loadRelaxed();
+    }
+    int Misses() const {
+        return misses.loadRelaxed();
+    }
+    // the hits which were answered by reflecting the NFP of the reversed pair
+    int Reflections() const {
+        return reflections.loadRelaxed();
+    }
+    // the hits which were read from the store
+    int StoreHits() const {
+        return storeHits.loadRelaxed();
+    }
+
+private:
+    // reversed is set if the key is the one of (B,A), whose NFP is then stored
+    static QByteArray MakeKey(const LB_Polygon2D &A, const LB_Polygon2D &B, bool inside, bool searchEdges,
+                              bool &reversed);
+    static QByteArray ShapeKey(const LB_Polygon2D &poly);
+
+    struct Entry {
+        QVector<LB_Polygon2D> nfp;
+        int points = 0;
+        // the use clock at the last hit, a hit sets it under the read lock
+        mutable QAtomicInteger<quint64> used;
+    };
+    // with the write lock held
+    void Add(const QByteArray &key, const QVector<LB_Polygon2D> &nfp) const;
+    void Evict() const;
+
+    mutable QReadWriteLock lock;
+    // Find() adds what it reads from the store
+    mutable QHash<QByteArray, Entry> table;
+    mutable qint64 points = 0;
+    qint64 capacity;
+    mutable QAtomicInteger<quint64> useClock;
+    QSharedPointer<LB_NFPStore> store;
+
+    mutable QAtomicInt hits;
+    mutable QAtomicInt misses;
+    mutable QAtomicInt reflections;
+    mutable QAtomicInt storeHits;
+    mutable QAtomicInt evictions;
+};
+
+}
+
+#endif // LB_NFPCACHE_H
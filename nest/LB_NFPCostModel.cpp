@@ -0,0 +1,193 @@
+#include "LB_NFPCostModel.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+// the coefficients are fitted again after this many new samples
+const int CALIBRATE_SAMPLES = 64;
+
+}
+
+namespace NFPHandle {
+
+int LB_NFPCostModel::ReflexCount(const LB_Polygon2D &poly)
+{
+    int n = poly.size();
+    if(n > 1 && poly.first() == poly.last())
+        n--;
+    if(n < 4 || poly.IsConvex())
+        return 0;
+
+    // a vertex turning against the orientation of the polygon
+    const double side = poly.IsAntiClockWise() ? 1 : -1;
+    int count = 0;
+    for(int i=0;i<n;++i) {
+        if(side*LB_Coord2D::ZCrossProduct(poly[(i+n-1)%n],poly[i],poly[(i+1)%n]) < 0)
+            count++;
+    }
+    return count;
+}
+
+void LB_NFPCostModel::Features(const LB_Polygon2D &A, const LB_Polygon2D &B, double f[FEATURES])
+{
+    const double pairs = double(A.size())*B.size();
+    f[0] = 1;
+    f[1] = pairs;
+    f[2] = pairs*(ReflexCount(A) + ReflexCount(B));
+}
+
+double LB_NFPCostModel::Predict(const LB_Polygon2D &A, const LB_Polygon2D &B) const
+{
+    double f[FEATURES];
+    Features(A,B,f);
+
+    QReadLocker locker(&lock);
+    double cost = 0;
+    for(int i=0;i<FEATURES;++i) {
+        cost += coefficients[i]*f[i];
+    }
+    return std::max(cost,0.0);
+}
+
+void LB_NFPCostModel::Record(const LB_Polygon2D &A, const LB_Polygon2D &B, qint64 nsecs)
+{
+    double f[FEATURES];
+    Features(A,B,f);
+
+    QMutexLocker locker(&sumsMutex);
+    for(int i=0;i<FEATURES;++i) {
+        for(int j=0;j<FEATURES;++j) {
+            ff[i][j] += f[i]*f[j];
+        }
+        fy[i] += f[i]*nsecs;
+    }
+    samples++;
+    if(samples - fitted < CALIBRATE_SAMPLES)
+        return;
+    locker.unlock();
+
+    Calibrate();
+}
+
+bool LB_NFPCostModel::Solve(const double sums[FEATURES][FEATURES+1], const bool fixed[FEATURES], double fit[FEATURES])
+{
+    // a fixed coefficient keeps the value in fit, its share is taken off the times
+    double m[FEATURES][FEATURES+1];
+    for(int i=0;i<FEATURES;++i) {
+        for(int j=0;j<=FEATURES;++j) {
+            m[i][j] = sums[i][j];
+        }
+    }
+    for(int i=0;i<FEATURES;++i) {
+        if(!fixed[i])
+            continue;
+        for(int j=0;j<FEATURES;++j) {
+            m[j][FEATURES] -= m[j][i]*fit[i];
+            m[i][j] = m[j][i] = 0;
+        }
+        m[i][i] = 1;
+        m[i][FEATURES] = fit[i];
+    }
+
+    // the features differ by orders of magnitude, they are scaled to a unit diagonal first
+    double scale[FEATURES];
+    for(int i=0;i<FEATURES;++i) {
+        scale[i] = std::sqrt(m[i][i]);
+    }
+    for(int i=0;i<FEATURES;++i) {
+        for(int j=0;j<FEATURES;++j) {
+            m[i][j] /= scale[i]*scale[j];
+        }
+        m[i][FEATURES] /= scale[i];
+    }
+
+    // gaussian elimination with partial pivoting
+    for(int col=0;col<FEATURES;++col) {
+        int pivot = col;
+        for(int row=col+1;row<FEATURES;++row) {
+            if(std::fabs(m[row][col]) > std::fabs(m[pivot][col]))
+                pivot = row;
+        }
+        if(std::fabs(m[pivot][col]) < 1e-12)
+            return false;
+        for(int k=0;k<=FEATURES;++k) {
+            std::swap(m[col][k],m[pivot][k]);
+        }
+        for(int row=0;row<FEATURES;++row) {
+            if(row == col)
+                continue;
+            const double factor = m[row][col]/m[col][col];
+            for(int k=col;k<=FEATURES;++k) {
+                m[row][k] -= factor*m[col][k];
+            }
+        }
+    }
+    for(int i=0;i<FEATURES;++i) {
+        fit[i] = m[i][FEATURES]/m[i][i]/scale[i];
+    }
+    return true;
+}
+
+void LB_NFPCostModel::Calibrate()
+{
+    double sums[FEATURES][FEATURES+1];
+    {
+        QMutexLocker locker(&sumsMutex);
+        if(samples < FEATURES)
+            return;
+        fitted = samples;
+        for(int i=0;i<FEATURES;++i) {
+            for(int j=0;j<FEATURES;++j) {
+                sums[i][j] = ff[i][j];
+            }
+            sums[i][FEATURES] = fy[i];
+        }
+    }
+
+    // a feature which was always 0 (only convex parts so far) keeps its coefficient
+    double old[FEATURES], fit[FEATURES];
+    bool fixed[FEATURES];
+    Coefficients(old[0],old[1],old[2]);
+    for(int i=0;i<FEATURES;++i) {
+        fit[i] = old[i];
+        fixed[i] = sums[i][i] <= 0;
+    }
+    // nearly dependent features keep the old fit
+    if(!Solve(sums,fixed,fit))
+        return;
+
+    // the orbits grow faster than the vertex pairs, which the fit answers with a negative constant,
+    // small pairs would then cost nothing; the line through the origin is used instead
+    if(fit[0] < 0) {
+        std::copy(old,old+FEATURES,fit);
+        fit[0] = 0;
+        fixed[0] = true;
+        if(!Solve(sums,fixed,fit))
+            return;
+    }
+
+    // more vertices never make an NFP cheaper, a fit saying so is noise
+    if(fit[1] < 0 || fit[2] < 0)
+        return;
+
+    QWriteLocker locker(&lock);
+    std::copy(fit,fit+FEATURES,coefficients);
+}
+
+int LB_NFPCostModel::Samples() const
+{
+    QMutexLocker locker(&sumsMutex);
+    return samples;
+}
+
+void LB_NFPCostModel::Coefficients(double &c0, double &c1, double &c2) const
+{
+    QReadLocker locker(&lock);
+    c0 = coefficients[0];
+    c1 = coefficients[1];
+    c2 = coefficients[2];
+}
+
+}
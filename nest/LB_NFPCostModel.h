@@ -0,0 +1,55 @@
+#ifndef LB_NFPCOSTMODEL_H
+#define LB_NFPCOSTMODEL_H
+
+#include <QReadWriteLock>
+#include <QMutex>
+
+#include "LB_Polygon2D.h"
+using namespace Shape2D;
+
+namespace NFPHandle {
+
+// predicts how long NoFitPolygon takes for a pair, in ns
+//   cost = c0 + c1*nA*nB + c2*nA*nB*(rA+rB)
+// n is the vertex number and r the number of reflex vertices: every orbit step tests the edges of
+// A against those of B, and concave parts take more steps and more touching contacts per step
+// the coefficients start from measured defaults and are fitted again by least squares to the
+// times of the computed NFPs reported with Record(), every CALIBRATE_SAMPLES of them
+// only the sums of the fit are kept, thread-safe
+class LB_NFPCostModel
+{
+public:
+    LB_NFPCostModel() {}
+
+    double Predict(const LB_Polygon2D &A, const LB_Polygon2D &B) const;
+    void Record(const LB_Polygon2D &A, const LB_Polygon2D &B, qint64 nsecs);
+
+    // fits the coefficients to the samples recorded so far
+    void Calibrate();
+
+    int Samples() const;
+    void Coefficients(double &c0, double &c1, double &c2) const;
+
+    static int ReflexCount(const LB_Polygon2D &poly);
+
+private:
+    static const int FEATURES = 3;
+    static void Features(const LB_Polygon2D &A, const LB_Polygon2D &B, double f[FEATURES]);
+    // least squares from the normal equations, the coefficients marked fixed keep their value in fit
+    static bool Solve(const double sums[FEATURES][FEATURES+1], const bool fixed[FEATURES], double fit[FEATURES]);
+
+    mutable QReadWriteLock lock;
+    // measured on a desktop core, the first calibration replaces them
+    double coefficients[FEATURES] = {0, 2500, 50};
+
+    // normal equations of the fit, sum of f*f' and of f*time
+    mutable QMutex sumsMutex;
+    double ff[FEATURES][FEATURES] = {};
+    double fy[FEATURES] = {};
+    int samples = 0;
+    int fitted = 0;
+};
+
+}
+
+#endif // LB_NFPCOSTMODEL_H
@@ -1,7 +1,286 @@
 #include "LB_NFPHandle.h"
+#include "LB_PreparedPolygon.h"
+
+#include <algorithm>
 
 namespace NFPHandle {
 
+namespace {
+
+struct EdgeDescriptor {
+    int8_t type;
+    int A;
+    int B;
+};
+
+struct TransVector {
+    double x;
+    double y;
+    LB_Coord2D start;
+    LB_Coord2D end;
+
+    bool operator==(const TransVector& other) const {
+        return this->x == other.x && this->y == other.y && this->start == other.start && this->end == other.end;
+    }
+
+    bool operator!=(const TransVector& other) const {
+        return !this->operator==(other);
+    }
+};
+
+const TransVector INVALID_TRANSVECTOR = {DIM_MAX, DIM_MAX, INVALID_POINT, INVALID_POINT};
+
+// uniform grid over the edges of a polygon, edge i runs from poly[i] to the next point (closed by the index)
+// every edge is filed in the cells its box covers, grown by margin or further for a short edge
+class EdgeGrid
+{
+public:
+    void Build(const LB_Polygon2D &poly, double margin)
+    {
+        const int n = poly.size();
+        double minX = DIM_MAX, minY = DIM_MAX, maxX = -DIM_MAX, maxY = -DIM_MAX;
+        boxes.resize(n);
+        for (int i = 0; i < n; i++) {
+            const LB_Coord2D &p = poly[i];
+            const LB_Coord2D &q = poly[(i+1 == n) ? 0 : i+1];
+            // OnSegment() reaches further off a short edge than margin
+            const double grow = std::max(margin, LB_Coord2D::OnSegmentReach(p, q));
+            boxes[i] = {std::min(p.X(), q.X()) - grow, std::min(p.Y(), q.Y()) - grow,
+                        std::max(p.X(), q.X()) + grow, std::max(p.Y(), q.Y()) + grow};
+            minX = std::min(minX, boxes[i].x0);
+            minY = std::min(minY, boxes[i].y0);
+            maxX = std::max(maxX, boxes[i].x1);
+            maxY = std::max(maxY, boxes[i].y1);
+        }
+        left = minX;
+        bottom = minY;
+        cols = rows = qBound(1, int(std::ceil(std::sqrt(double(n)))), 64);
+        cellWid = (maxX - minX) / cols;
+        cellHei = (maxY - minY) / rows;
+
+        // counting sort of the edges into the cells
+        cellStart.fill(0, cols*rows + 1);
+        for (int pass = 0; pass < 2; pass++) {
+            if (pass == 1) {
+                for (int c = 0; c < cols*rows; c++) {
+                    cellStart[c+1] += cellStart[c];
+                }
+                items.resize(cellStart[cols*rows]);
+                cellFill = cellStart;
+            }
+            for (int i = 0; i < n; i++) {
+                int c0 = Col(boxes[i].x0), c1 = Col(boxes[i].x1);
+                int r0 = Row(boxes[i].y0), r1 = Row(boxes[i].y1);
+                for (int r = r0; r <= r1; r++) {
+                    for (int c = c0; c <= c1; c++) {
+                        if (pass == 0) {
+                            cellStart[r*cols + c + 1]++;
+                        } else {
+                            items[cellFill[r*cols + c]++] = i;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // calls f(i) for every edge whose grown box holds (px,py)
+    template<class F> void Query(double px, double py, F f) const
+    {
+        if (px < left || py < bottom || px > left + cols*cellWid || py > bottom + rows*cellHei) {
+            return;
+        }
+        int cell = Row(py)*cols + Col(px);
+        for (int k = cellStart[cell]; k < cellStart[cell+1]; k++) {
+            const Box &box = boxes[items[k]];
+            if (px >= box.x0 && px <= box.x1 && py >= box.y0 && py <= box.y1) {
+                f(items[k]);
+            }
+        }
+    }
+
+private:
+    struct Box {
+        double x0, y0, x1, y1;
+    };
+
+    int Col(double px) const {
+        return cellWid > 0 ? qBound(0, int((px - left) / cellWid), cols - 1) : 0;
+    }
+    int Row(double py) const {
+        return cellHei > 0 ? qBound(0, int((py - bottom) / cellHei), rows - 1) : 0;
+    }
+
+    double left = 0;
+    double bottom = 0;
+    double cellWid = 0;
+    double cellHei = 0;
+    int cols = 1;
+    int rows = 1;
+    QVector<Box> boxes;
+    QVector<int> cellStart;
+    QVector<int> cellFill;
+    QVector<int> items;
+};
+
+// buffers of the orbit, one set per thread
+// cleared but never freed, so once they have grown the orbit doesn't allocate anymore
+struct OrbitScratch {
+    QVector<EdgeDescriptor> touching;
+    QVector<TransVector> vectors;
+    // contact search: A's edges where they are, B's edges where B started the orbit
+    EdgeGrid gridA;
+    EdgeGrid gridB;
+    QVector<qint64> candidates;
+};
+
+// cell size of the NFP vertex hash, much larger than FLOAT_TOL
+const double NFP_VERTEX_CELL = 1e-6;
+
+// the vertices of a set of NFPs hashed on a fine grid, a point matches like in InNfp()
+// fuzzy equal points are at most one cell apart, so a lookup checks the 3x3 cells around the point
+class NfpVertexSet
+{
+public:
+    explicit NfpVertexSet(const QVector<LB_Polygon2D> &nfp)
+    {
+        foreach(const LB_Polygon2D &poly, nfp){
+            foreach(const LB_Coord2D &p, poly){
+                quint64 key = Key(Cell(p.X()), Cell(p.Y()));
+                next.push_back(first.value(key, -1));
+                first.insert(key, points.size());
+                points.push_back(p);
+            }
+        }
+    }
+
+    bool Contains(const LB_Coord2D &p) const
+    {
+        if(points.isEmpty()){
+            return false;
+        }
+        qint64 cx = Cell(p.X());
+        qint64 cy = Cell(p.Y());
+        for(qint64 x = cx-1; x <= cx+1; x++){
+            for(qint64 y = cy-1; y <= cy+1; y++){
+                for(int k = first.value(Key(x, y), -1); k >= 0; k = next[k]){
+                    if(p == points[k]){
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    static qint64 Cell(double v) {
+        return qint64(std::floor(v / NFP_VERTEX_CELL));
+    }
+    static quint64 Key(qint64 x, qint64 y) {
+        return quint64(x) * 0x9E3779B97F4A7C15ULL ^ quint64(y);
+    }
+
+    QHash<quint64, int> first;
+    QVector<int> next;
+    QVector<LB_Coord2D> points;
+};
+
+// unit vectors closer than this to an edge direction are never rejected
+const double CONE_TOL = 1e-6;
+
+// d points strictly to the interior side of the edge s1 s2
+inline bool IntoEdge(const LB_Coord2D &s1, const LB_Coord2D &s2, double side, const LB_Coord2D &d)
+{
+    LB_Coord2D e = s2 - s1;
+    double len = sqrt(e.Dot(e));
+    return len > FLOAT_TOL && side * e.Cross(d) / len > CONE_TOL;
+}
+
+// d points strictly into the interior of poly at vertex i, d is a unit vector
+inline bool IntoVertex(const LB_Polygon2D &poly, int i, double side, const LB_Coord2D &d)
+{
+    int previ = (i == 0) ? poly.size()-1 : i-1;
+    int nexti = (i == poly.size()-1) ? 0 : i+1;
+    LB_Coord2D e1 = poly[nexti] - poly[i];
+    LB_Coord2D e2 = poly[previ] - poly[i];
+    double len1 = sqrt(e1.Dot(e1));
+    double len2 = sqrt(e2.Dot(e2));
+    if(len1 <= FLOAT_TOL || len2 <= FLOAT_TOL){
+        return false;
+    }
+    e1 = e1 * (1/len1);
+    e2 = e2 * (1/len2);
+    if(side < 0){
+        std::swap(e1, e2);
+    }
+
+    // the interior is swept anticlockwise from e1 to e2
+    double turn = e1.Cross(e2);
+    if(turn > CONE_TOL){
+        return e1.Cross(d) > CONE_TOL && d.Cross(e2) > CONE_TOL;
+    }
+    if(turn < -CONE_TOL){
+        return e2.Cross(d) < -CONE_TOL || d.Cross(e1) < -CONE_TOL;
+    }
+    // straight vertex, or a spike whose wedge is empty
+    return e1.Dot(e2) < 0 && e1.Cross(d) > CONE_TOL;
+}
+
+// moving B by v makes it overlap A right away at one of the contacts
+bool Blocked(const LB_Polygon2D &A, const LB_Polygon2D &B, const QVector<EdgeDescriptor> &touching,
+             const LB_Coord2D &v, double sideA, double sideB)
+{
+    LB_Coord2D d = v.Normalized();
+    LB_Coord2D back = d * -1;
+    foreach(const EdgeDescriptor &contact, touching){
+        if(contact.type == 0){
+            // vertex on vertex
+            if(IntoVertex(A, contact.A, sideA, d) || IntoVertex(B, contact.B, sideB, back)){
+                return true;
+            }
+        }
+        else if(contact.type == 1){
+            // vertex of B on the edge of A ending at contact.A
+            int prevA = (contact.A == 0) ? A.size()-1 : contact.A-1;
+            if(IntoEdge(A[prevA], A[contact.A], sideA, d) || IntoVertex(B, contact.B, sideB, back)){
+                return true;
+            }
+        }
+        else{
+            // vertex of A on the edge of B ending at contact.B
+            int prevB = (contact.B == 0) ? B.size()-1 : contact.B-1;
+            if(IntoEdge(B[prevB], B[contact.B], sideB, back) || IntoVertex(A, contact.A, sideA, d)){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// below this many vertex pairs the full contact test is cheaper than the grids
+const int CONTACT_GRID_PAIRS = 256;
+
+// the contact between vertex i of A and vertex j of B, if there is one
+inline void FindContact(const LB_Polygon2D &A, const LB_Polygon2D &B, int i, int j, QVector<EdgeDescriptor> &touching)
+{
+    int nexti = (i==A.size()-1) ? 0 : i+1;
+    int nextj = (j==B.size()-1) ? 0 : j+1;
+    if(A[i] == B[j]){
+        touching.push_back({ 0, i, j });
+    }
+    else if(LB_Coord2D::OnSegment(A[i],A[nexti],B[j])){
+        touching.push_back({	1, nexti, j });
+    }
+    else if(LB_Coord2D::OnSegment(B[j],B[nextj],A[i])){
+        touching.push_back({	2, i, nextj });
+    }
+}
+
+thread_local OrbitScratch scratch;
+
+}
+
 double PointDistance(const LB_Coord2D &p, const LB_Coord2D &s1, const LB_Coord2D &s2, LB_Coord2D normal, bool infinite)
 {
     normal.Normalize();
@@ -116,13 +395,14 @@ double SegmentDistance(const LB_Coord2D &A, const LB_Coord2D &B, const LB_Coord2
         return DIM_MAX;
     }
 
-    std::vector<double> distances;
+    // the smallest of at most four candidates, kept on the stack
+    double distance = DIM_MAX;
 
     // coincident points
     if (FuzzyEqual(dotA, dotE)) {
-        distances.push_back(crossA - crossE);
+        distance = std::min(distance, crossA - crossE);
     } else if (FuzzyEqual(dotA, dotF)) {
-        distances.push_back(crossA - crossF);
+        distance = std::min(distance, crossA - crossF);
     } else if (dotA > EFmin && dotA < EFmax) {
         double d = PointDistance(A, E, F, reverse);
         if (d != DIM_MAX && FuzzyEqual(d, 0)) { //  A currently touches EF, but AB is moving away from EF
@@ -132,14 +412,14 @@ double SegmentDistance(const LB_Coord2D &A, const LB_Coord2D &B, const LB_Coord2
             }
         }
         if (d != DIM_MAX) {
-            distances.push_back(d);
+            distance = std::min(distance, d);
         }
     }
 
     if (FuzzyEqual(dotB, dotE)) {
-        distances.push_back(crossB - crossE);
+        distance = std::min(distance, crossB - crossE);
     } else if (FuzzyEqual(dotB, dotF)) {
-        distances.push_back(crossB - crossF);
+        distance = std::min(distance, crossB - crossF);
     } else if (dotB > EFmin && dotB < EFmax) {
         double d = PointDistance(B, E, F, reverse);
 
@@ -150,7 +430,7 @@ double SegmentDistance(const LB_Coord2D &A, const LB_Coord2D &B, const LB_Coord2
             }
         }
         if (d != DIM_MAX) {
-            distances.push_back(d);
+            distance = std::min(distance, d);
         }
     }
 
@@ -163,7 +443,7 @@ double SegmentDistance(const LB_Coord2D &A, const LB_Coord2D &B, const LB_Coord2
             }
         }
         if (d != DIM_MAX) {
-            distances.push_back(d);
+            distance = std::min(distance, d);
         }
     }
 
@@ -176,46 +456,37 @@ double SegmentDistance(const LB_Coord2D &A, const LB_Coord2D &B, const LB_Coord2
             }
         }
         if (d != DIM_MAX) {
-            distances.push_back(d);
+            distance = std::min(distance, d);
         }
     }
 
-    if (distances.size() == 0) {
-        return DIM_MAX;
-    }
-
-    return *std::min_element(distances.begin(), distances.end());
+    return distance;
 }
 
-double PolygonSlideDistance(LB_Polygon2D A, LB_Polygon2D B, const LB_Coord2D &direction, bool ignoreNegative)
+double PolygonSlideDistance(const LB_Polygon2D &A, const LB_Polygon2D &B, const LB_Coord2D &direction, bool ignoreNegative)
 {
-    LB_Coord2D A1, A2, B1, B2;
-
-    // close the loop for polygons
-    if (A[0] != A[A.size() - 1]) {
-        A.push_back(A.front());
-    }
-
-    if (B[0] != B[B.size() - 1]) {
-        B.push_back(B.front());
-    }
-
-    LB_Polygon2D edgeA = A;
-    LB_Polygon2D edgeB = B;
+    // the loops are closed by the index, no copy of A or B is made
+    // a polygon which repeats its first point ends with a zero length edge, which is skipped
+    const int sizeA = A.size();
+    const int sizeB = B.size();
 
     double distance = DIM_MAX;
     double d;
 
     LB_Coord2D dir = direction.Normalized();
 
-    for (int i = 0; i < edgeB.size() - 1; i++) {
-        for (int j = 0; j < edgeA.size() - 1; j++) {
-            A1 = edgeA[j];
-            A2 = edgeA[j+1];
-            B1 = edgeB[i];
-            B2 = edgeB[i+1];
+    for (int i = 0; i < sizeB; i++) {
+        const LB_Coord2D &B1 = B[i];
+        const LB_Coord2D &B2 = B[(i+1 == sizeB) ? 0 : i+1];
+        if (B1 == B2) {
+            continue; // ignore extremely small lines
+        }
+
+        for (int j = 0; j < sizeA; j++) {
+            const LB_Coord2D &A1 = A[j];
+            const LB_Coord2D &A2 = A[(j+1 == sizeA) ? 0 : j+1];
 
-            if((A1 == A2) || (B1 == B2)) {
+            if (A1 == A2) {
                 continue; // ignore extremely small lines
             }
 
@@ -231,32 +502,22 @@ double PolygonSlideDistance(LB_Polygon2D A, LB_Polygon2D B, const LB_Coord2D &di
     return distance;
 }
 
-double PolygonProjectionDistance(LB_Polygon2D A, LB_Polygon2D B, const LB_Coord2D &direction)
+double PolygonProjectionDistance(const LB_Polygon2D &A, const LB_Polygon2D &B, const LB_Coord2D &direction)
 {
-    // close the loop for polygons
-    if (A[0] != A[A.size() - 1]) {
-        A.push_back(A[0]);
-    }
-
-    if (B[0] != B[B.size() - 1]) {
-        B.push_back(B[0]);
-    }
-
-    LB_Polygon2D edgeA = A;
-    LB_Polygon2D edgeB = B;
+    // closed by the index like PolygonSlideDistance, the first point of B stands for the closing one
+    const int sizeA = A.size();
+    const int sizeB = B.size();
 
     double distance = DIM_MAX;
-    LB_Coord2D p, s1, s2;
     double d;
 
-    for (int i = 0; i < edgeB.size(); i++) {
+    for (int i = 0; i < sizeB; i++) {
+        const LB_Coord2D &p = B[i];
         // the shortest/most negative projection of B onto A
         double minprojection = DIM_MAX;
-        LB_Coord2D minp = INVALID_POINT;
-        for (int j = 0; j < edgeA.size() - 1; j++) {
-            p = edgeB[i];
-            s1 = edgeA[j];
-            s2 = edgeA[j+1];
+        for (int j = 0; j < sizeA; j++) {
+            const LB_Coord2D &s1 = A[j];
+            const LB_Coord2D &s2 = A[(j+1 == sizeA) ? 0 : j+1];
 
             if(fabs((s2.Y()-s1.Y()) * direction.X() - (s2.X()-s1.X()) * direction.Y()) < FLOAT_TOL) {
                 continue;
@@ -267,7 +528,6 @@ double PolygonProjectionDistance(LB_Polygon2D A, LB_Polygon2D B, const LB_Coord2
 
             if(d != DIM_MAX && (minprojection == DIM_MAX || d < minprojection)) {
                 minprojection = d;
-                minp = p;
             }
         }
         if (minprojection != DIM_MAX
@@ -307,10 +567,15 @@ LB_Coord2D SearchStartPoint(LB_Polygon2D A, LB_Polygon2D B, bool inside, const Q
         B.push_back(B[0]);
     }
 
+    // A doesn't move, every candidate position of B is located and intersected against the same bands
+    // and checked against the same visited vertices
+    const LB_PreparedPolygon preparedA(A);
+    const NfpVertexSet visited(NFP);
+
     double bdx=0,bdy=0;
     for (int i = 0; i < A.size() - 1; i++) {
         if (!A[i].Marked()) {
-            A[i].setMarked(true);
+            A.SetMarked(i, true);
             for (int j = 0; j < B.size(); j++) {
                 B.Translate(A[i].X() - B[j].X(),
                             A[i].Y() - B[j].Y());
@@ -319,7 +584,7 @@ LB_Coord2D SearchStartPoint(LB_Polygon2D A, LB_Polygon2D B, bool inside, const Q
 
                 PointInPolygon Binside = PointInPolygon::INVALID;
                 for (int k = 0; k < B.size(); k++) {
-                    PointInPolygon inpoly = A.ContainPoint(B[k]);
+                    PointInPolygon inpoly = preparedA.ContainPoint(B[k]);
                     if (inpoly != PointInPolygon::INVALID) {
                         Binside = inpoly;
                         break;
@@ -331,8 +596,8 @@ LB_Coord2D SearchStartPoint(LB_Polygon2D A, LB_Polygon2D B, bool inside, const Q
                 }
 
                 LB_Coord2D startPoint = { bdx, bdy };
-                if (((Binside && inside) || (!Binside && !inside)) && !A.Intersect(B)
-                        && !InNfp(startPoint, NFP)) {
+                if (((Binside && inside) || (!Binside && !inside)) && !preparedA.Intersect(B)
+                        && !visited.Contains(startPoint)) {
                     return startPoint;
                 }
 
@@ -377,15 +642,15 @@ LB_Coord2D SearchStartPoint(LB_Polygon2D A, LB_Polygon2D B, bool inside, const Q
                 B.Translate(vx,vy);
 
                 for (int k = 0; k < B.size(); k++) {
-                    PointInPolygon inpoly = A.ContainPoint(B[k]);
+                    PointInPolygon inpoly = preparedA.ContainPoint(B[k]);
                     if (inpoly == PointInPolygon::INVALID) {
                         Binside = inpoly;
                         break;
                     }
                 }
                 startPoint = {bdx, bdy};
-                if (((Binside && inside) || (!Binside && !inside)) && !A.Intersect(B)
-                        && !InNfp(startPoint, NFP)) {
+                if (((Binside && inside) || (!Binside && !inside)) && !preparedA.Intersect(B)
+                        && !visited.Contains(startPoint)) {
                     return startPoint;
                 }
             }
@@ -452,7 +717,8 @@ QVector<LB_Polygon2D> NoFitPolygonRectangle(const LB_Polygon2D &A, const LB_Poly
         }};
 }
 
-QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside, bool searchEdges)
+QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside, bool searchEdges,
+                                   LB_NestControl *control)
 {
     if(A.size() < 3 || B.size() < 3){
         return {};
@@ -467,7 +733,7 @@ QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside,
     int maxBindex = 0;
 
     for(i=1; i<A.size(); i++){
-        A[i].setMarked(false);
+        A.SetMarked(i, false);
         if(A[i].Y() < minA){
             minA = A[i].Y();
             minAindex = i;
@@ -475,7 +741,7 @@ QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside,
     }
 
     for(i=1; i<B.size(); i++){
-        B[i].setMarked(false);
+        B.SetMarked(i, false);
         if(B[i].Y() > maxB){
             maxB = B[i].Y();
             maxBindex = i;
@@ -497,18 +763,30 @@ QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside,
 
     QVector<LB_Polygon2D> NFPlist;
 
-    struct EdgeDescriptor {
-        int8_t type;
-        int A;
-        int B;
-    };
+    // maintain a list of touching points/edges
+    QVector<EdgeDescriptor> &touching = scratch.touching;
+    QVector<TransVector> &vectors = scratch.vectors;
+    QVector<qint64> &candidates = scratch.candidates;
+
+    // the side of an edge the interior lies on, 1 for anticlockwise polygons
+    // orbiting inside, the outside of A is what B mustn't enter
+    const double sideA = (A.IsAntiClockWise() ? 1 : -1) * (inside ? -1 : 1);
+    const double sideB = B.IsAntiClockWise() ? 1 : -1;
+
+    // A stays put and B only moves by translation, so the grids are built once per orbit
+    // the margin covers the fuzzy compares and the rounding of B's moves
+    const bool useGrids = A.size()*B.size() > CONTACT_GRID_PAIRS;
+    double extent = 0;
+    if(useGrids){
+        foreach(const LB_Coord2D &p, A){
+            extent = std::max(extent, std::max(fabs(p.X()), fabs(p.Y())));
+        }
+        scratch.gridA.Build(A, 1e-6 + extent*1e-10);
+    }
 
     while(startpoint != INVALID_POINT){
         B.Translate(startpoint.X(),startpoint.Y());
 
-        // maintain a list of touching points/edges
-        QVector<EdgeDescriptor> touching;
-
         LB_Coord2D prevvector = INVALID_POINT; // keep track of previous vector
         LB_Polygon2D NFP;
         NFP.push_back(B[0]);
@@ -519,43 +797,56 @@ QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside,
         double starty = referencey;
         int counter = 0;
 
+        if(useGrids){
+            double extentB = extent;
+            foreach(const LB_Coord2D &p, B){
+                extentB = std::max(extentB, std::max(fabs(p.X()), fabs(p.Y())));
+            }
+            scratch.gridB.Build(B, 1e-6 + extentB*1e-10);
+        }
+
         while(counter < 10*(A.size() + B.size())){ // sanity check, prevent infinite loop
-            touching = {};
+            if(control && !control->CheckPoint()){
+                return {};
+            }
+
+            touching.clear();
             // find touching vertices/edges
-            for(i=0; i<A.size(); i++){
-                int nexti = (i==A.size()-1) ? 0 : i+1;
-                for(j=0; j<B.size(); j++){
-                    int nextj = (j==B.size()-1) ? 0 : j+1;
-                    if(A[i] == B[j]){
-                        touching.push_back({ 0, i, j });
-                    }
-                    else if(LB_Coord2D::OnSegment(A[i],A[nexti],B[j])){
-                        touching.push_back({	1, nexti, j });
-                    }
-                    else if(LB_Coord2D::OnSegment(B[j],B[nextj],A[i])){
-                        touching.push_back({	2, i, nextj });
+            if(!useGrids){
+                for(i=0; i<A.size(); i++){
+                    for(j=0; j<B.size(); j++){
+                        FindContact(A, B, i, j, touching);
                     }
                 }
             }
-
-            struct TransVector {
-                double x;
-                double y;
-                LB_Coord2D start;
-                LB_Coord2D end;
-
-                bool operator==(const TransVector& other) const {
-                    return this->x == other.x && this->y == other.y && this->start == other.start && this->end == other.end;
+            else{
+                // only the pairs where a vertex lies in the grown box of an edge of the other polygon can touch
+                // tested in the order of the full search, so the touching list is the same
+                candidates.clear();
+                const qint64 sizeB = B.size();
+                for(j=0; j<B.size(); j++){
+                    scratch.gridA.Query(B[j].X(), B[j].Y(), [&](int edge) {
+                        candidates.push_back(edge*sizeB + j);
+                    });
                 }
-
-                bool operator!=(const TransVector& other) const {
-                    return !this->operator==(other);
+                const double offsetx = referencex - startx;
+                const double offsety = referencey - starty;
+                for(i=0; i<A.size(); i++){
+                    scratch.gridB.Query(A[i].X() - offsetx, A[i].Y() - offsety, [&](int edge) {
+                        candidates.push_back(i*sizeB + edge);
+                    });
+                }
+                std::sort(candidates.begin(), candidates.end());
+                for(int k=0; k<candidates.size(); k++){
+                    if(k > 0 && candidates[k] == candidates[k-1]){
+                        continue;
+                    }
+                    FindContact(A, B, int(candidates[k] / sizeB), int(candidates[k] % sizeB), touching);
                 }
-            };
+            }
 
-            const TransVector INVALID_TRANSVECTOR = {DIM_MAX, DIM_MAX, INVALID_POINT, INVALID_POINT};
             // generate translation vectors from touching vertices/edges
-            QVector<TransVector> vectors;
+            vectors.clear();
             for(i=0; i<touching.size(); i++){
                 LB_Coord2D vertexA = A[touching[i].A];
                 vertexA.setMarked(true);
@@ -649,7 +940,8 @@ QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside,
                 }
             }
 
-            // todo: there should be a faster way to reject vectors that will cause immediate intersection. For now just check them all
+            // vectors that run into a contact at once can't be chosen (their slide distance is 0)
+            // they are rejected by the cones of free directions at the contacts before any slide distance is computed
 
             TransVector translate = INVALID_TRANSVECTOR;
             double maxd = 0;
@@ -659,6 +951,15 @@ QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside,
                     continue;
                 }
 
+                // a repeated vector has the same distance and can't win
+                bool repeated = false;
+                for(j=0; j<i && !repeated; j++){
+                    repeated = vectors[j].x == vectors[i].x && vectors[j].y == vectors[i].y;
+                }
+                if(repeated){
+                    continue;
+                }
+
                 // if this vector points us back to where we came from, ignore it.
                 // ie cross product = 0, dot product < 0
                 if(prevvector != INVALID_POINT && vectors[i].y * prevvector.Y() + vectors[i].x * prevvector.X() < 0){
@@ -676,6 +977,10 @@ QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside,
                 }
 
                 LB_Coord2D pv = {vectors[i].x, vectors[i].y};
+                if(Blocked(A, B, touching, pv, sideA, sideB)){
+                    continue;
+                }
+
                 double d = PolygonSlideDistance(A, B, pv, true);
                 double vecd2 = vectors[i].x*vectors[i].x + vectors[i].y*vectors[i].y;
 
@@ -2,6 +2,7 @@
 #define LB_NFPHANDLE_H
 
 #include "LB_Polygon2D.h"
+#include "LB_NestControl.h"
 using namespace Shape2D;
 
 namespace NFPHandle {
@@ -12,10 +13,11 @@ double PointDistance(const LB_Coord2D& p, const LB_Coord2D& s1, const LB_Coord2D
 double SegmentDistance(const LB_Coord2D& A, const LB_Coord2D& B, const LB_Coord2D& E,
                       const LB_Coord2D& F, const LB_Coord2D& direction);
 
-double PolygonSlideDistance(LB_Polygon2D A, LB_Polygon2D B, const LB_Coord2D& direction,
+// A and B may be open or closed (first point repeated at the end), they aren't copied
+double PolygonSlideDistance(const LB_Polygon2D& A, const LB_Polygon2D& B, const LB_Coord2D& direction,
                            bool ignoreNegative);
 
-double PolygonProjectionDistance(LB_Polygon2D A, LB_Polygon2D B, const LB_Coord2D& direction);
+double PolygonProjectionDistance(const LB_Polygon2D& A, const LB_Polygon2D& B, const LB_Coord2D& direction);
 
 // returns true if point already exists in the given nfp
 bool InNfp(const LB_Coord2D& p, const QVector<LB_Polygon2D>& nfp);
@@ -31,7 +33,9 @@ QVector<LB_Polygon2D> NoFitPolygonRectangle(const LB_Polygon2D& A, const LB_Poly
 // given a static polygon A and a movable polygon B, compute a no fit polygon by orbiting B about A
 // if the inside flag is set, B is orbited inside of A rather than outside
 // if the searchEdges flag is set, all edges of A are explored for NFPs - multiple
-QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside, bool searchEdges);
+// if a control is given it is checked at every orbit step, a canceled NFP is returned empty
+QVector<LB_Polygon2D> NoFitPolygon(LB_Polygon2D A, LB_Polygon2D B, bool inside, bool searchEdges,
+                                   LB_NestControl *control = nullptr);
 
 }
 
@@ -0,0 +1,55 @@
+#include "LB_NFPPrefetch.h"
+
+#include <QThread>
+#include <QtConcurrent>
+
+LB_NFPPrefetch::LB_NFPPrefetch()
+{
+    pool.setMaxThreadCount(1);
+}
+
+LB_NFPPrefetch::~LB_NFPPrefetch()
+{
+    Cancel();
+    future.waitForFinished();
+}
+
+void LB_NFPPrefetch::Start(const LB_NestConfig &config, const QVector<LB_Polygon2D> &polygons,
+                           const QSharedPointer<LB_NFPCache> &cache)
+{
+    Cancel();
+    runCache.reset();
+    if(polygons.isEmpty() || !cache)
+        return;
+
+    // the run shares them with the caller
+    foreach(const LB_Polygon2D &aPolygon,polygons) {
+        aPolygon.UpdateCache();
+    }
+
+    control.reset(new LB_NestControl);
+    runCache.reset(new LB_NFPCache);
+    QSharedPointer<LB_NestControl> aControl = control;
+    QSharedPointer<LB_NFPCache> aRunCache = runCache;
+    future = QtConcurrent::run(&pool,[=]() {
+        // idle runs only on a core nothing else wants, lowest still competes with the nests
+        QThread::currentThread()->setPriority(QThread::IdlePriority);
+
+        // no checkpoint, export or receiver, only the cache keeps something
+        // its NFP batches stay in this thread too
+        LB_NestEngine engine(config);
+        engine.SetCache(cache);
+        engine.SetRunCache(aRunCache);
+        engine.SetControl(aControl);
+        engine.SetThreaded(false);
+        engine.SetPolygons(polygons);
+        engine.Run();
+    });
+}
+
+void LB_NFPPrefetch::Cancel()
+{
+    if(control)
+        control->Cancel();
+    control.reset();
+}
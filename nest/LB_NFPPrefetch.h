@@ -0,0 +1,48 @@
+#ifndef LB_NFPPREFETCH_H
+#define LB_NFPPREFETCH_H
+
+#include <QFuture>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+#include "LB_NestEngine.h"
+
+// NFPs of a job computed before its nest starts, while the machine would wait anyway
+// the job is nested once in the background into the cache the real nest will use, in one thread
+// of its own at idle priority, and the result is thrown away; the nest is deterministic, so the real one finds
+// the NFPs of its first parts and strips (the largest ones, which the sort order places first)
+// in the cache until it gets further than the prefetch did; the NFPs against the unions of the
+// placed parts go to a run cache of their own, which the real nest of the job takes over
+class LB_NFPPrefetch
+{
+public:
+    LB_NFPPrefetch();
+    ~LB_NFPPrefetch();
+    Q_DISABLE_COPY(LB_NFPPrefetch)
+
+    // cancels the job prefetched before
+    void Start(const LB_NestConfig &config, const QVector<LB_Polygon2D> &polygons,
+               const QSharedPointer<LB_NFPCache> &cache);
+    // returns at once, the background nest stops within one orbit step
+    // call it when the job changes or its nest starts, the two would only compute the same NFPs
+    void Cancel();
+    bool IsRunning() const {
+        return future.isRunning();
+    }
+    // the run cache of the job prefetched last, for LB_NestEngine::SetRunCache() of its nest
+    // the prefetch keeps none afterwards, call Cancel() too
+    QSharedPointer<LB_NFPCache> TakeRunCache() {
+        QSharedPointer<LB_NFPCache> aCache = runCache;
+        runCache.reset();
+        return aCache;
+    }
+
+private:
+    QSharedPointer<LB_NestControl> control;
+    QSharedPointer<LB_NFPCache> runCache;
+    QFuture<void> future;
+    // not the global pool, whose threads the nests in the foreground need
+    QThreadPool pool;
+};
+
+#endif // LB_NFPPREFETCH_H
@@ -0,0 +1,103 @@
+#include "LB_NFPScheduler.h"
+#include "LB_NFPHandle.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+// predicted ns below which handing work to another thread costs more than it saves
+const double MIN_CHUNK_COST = 50000;
+// chunks per core, so the cores finishing early still find work
+const int CHUNKS_PER_THREAD = 4;
+
+}
+
+namespace NFPHandle {
+
+LB_NFPScheduler::LB_NFPScheduler(LB_NFPCache *aCache, LB_NFPCache *aRunCache, LB_NFPCostModel *aModel,
+                                 LB_NestControl *aControl, bool aThreaded) :
+    cache(aCache),
+    runCache(aRunCache),
+    model(aModel),
+    control(aControl),
+    threaded(aThreaded)
+{
+}
+
+void LB_NFPScheduler::Compute(LB_NFPTask &task) const
+{
+    if(control && control->IsCanceled())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+    task.nfp = NoFitPolygon(*task.A,*task.B,false,false,control);
+    if(control && control->IsCanceled())
+        return;
+
+    if(model)
+        model->Record(*task.A,*task.B,timer.nsecsElapsed());
+    if(LB_NFPCache *aCache = CacheOf(task))
+        aCache->Insert(*task.A,*task.B,false,false,task.nfp);
+}
+
+void LB_NFPScheduler::Run(QVector<LB_NFPTask> &tasks) const
+{
+    // 1.the pairs met before
+    QVector<int> order;
+    QVector<double> costs(tasks.size(),0);
+    double total = 0;
+    for(int i=0;i<tasks.size();++i) {
+        tasks[i].nfp.clear();
+        LB_NFPCache *aCache = CacheOf(tasks[i]);
+        if(aCache && aCache->Find(*tasks[i].A,*tasks[i].B,false,false,tasks[i].nfp))
+            continue;
+        if(model)
+            costs[i] = model->Predict(*tasks[i].A,*tasks[i].B);
+        total += costs[i];
+        order.append(i);
+    }
+    if(order.isEmpty())
+        return;
+
+    // 2.the most expensive first, without a model they all stay in one chunk
+    std::stable_sort(order.begin(),order.end(),[&costs](int a, int b) {
+        return costs[a] > costs[b];
+    });
+
+    // 3.expensive pairs run alone, the cheap tail is cut into chunks of about target each
+    const double target = qMax(MIN_CHUNK_COST,total/(QThread::idealThreadCount()*CHUNKS_PER_THREAD));
+    QVector<QVector<int>> chunks;
+    double chunkCost = 0;
+    foreach(int i,order) {
+        if(chunks.isEmpty() || (chunkCost > 0 && chunkCost + costs[i] > target)) {
+            chunks.append(QVector<int>());
+            chunkCost = 0;
+        }
+        chunks.last().append(i);
+        chunkCost += costs[i];
+    }
+
+    if(chunks.size() == 1 || !threaded) {
+        foreach(int i,order) {
+            Compute(tasks[i]);
+        }
+        return;
+    }
+    // the tasks share A, the cost model and the cache read its cached properties from every thread
+    foreach(int i,order) {
+        tasks[i].A->UpdateCache();
+        tasks[i].B->UpdateCache();
+    }
+    // the chunks are handed out in order, the calling thread takes part
+    QtConcurrent::blockingMap(chunks,[&](const QVector<int> &chunk) {
+        foreach(int i,chunk) {
+            Compute(tasks[i]);
+        }
+    });
+}
+
+}
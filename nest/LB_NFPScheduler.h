@@ -0,0 +1,54 @@
+#ifndef LB_NFPSCHEDULER_H
+#define LB_NFPSCHEDULER_H
+
+#include <QVector>
+
+#include "LB_NFPCache.h"
+#include "LB_NFPCostModel.h"
+#include "LB_NestControl.h"
+
+namespace NFPHandle {
+
+// one NFP of B orbiting outside A, the polygons must outlive the run
+struct LB_NFPTask
+{
+    const LB_Polygon2D *A = nullptr;
+    const LB_Polygon2D *B = nullptr;
+    // false if A is met by this run only, its NFPs are then kept in the run cache
+    bool shared = true;
+    QVector<LB_Polygon2D> nfp;
+};
+
+// computes a batch of independent NFPs on all cores
+// the pairs the cache doesn't know are started by predicted cost, the most expensive first, so a
+// long orbit doesn't start last and keep the other cores waiting at the end
+// cheap pairs are run in chunks worth about a thread hop or more, and a batch predicted to be
+// cheaper than that runs in the calling thread
+// every computed NFP is timed for the cost model and inserted into the cache
+// a scheduler which isn't threaded computes every batch in the calling thread
+class LB_NFPScheduler
+{
+public:
+    // caches and model may be null, the tasks which aren't shared use runCache
+    LB_NFPScheduler(LB_NFPCache *aCache, LB_NFPCache *aRunCache, LB_NFPCostModel *aModel,
+                    LB_NestControl *aControl = nullptr, bool aThreaded = true);
+
+    // fills the nfp of every task, an orbit cut short by a cancel is neither cached nor timed
+    void Run(QVector<LB_NFPTask> &tasks) const;
+
+private:
+    void Compute(LB_NFPTask &task) const;
+    LB_NFPCache *CacheOf(const LB_NFPTask &task) const {
+        return task.shared ? cache : runCache;
+    }
+
+    LB_NFPCache *cache;
+    LB_NFPCache *runCache;
+    LB_NFPCostModel *model;
+    LB_NestControl *control;
+    bool threaded;
+};
+
+}
+
+#endif // LB_NFPSCHEDULER_H
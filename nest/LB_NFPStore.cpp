@@ -0,0 +1,357 @@
+#include "LB_NFPStore.h"
+#include "LB_NestIO.h"
+
+#include <QSaveFile>
+#include <QDataStream>
+#include <QtEndian>
+#include <QtConcurrent>
+
+namespace {
+
+const quint32 STORE_MAGIC = 0x4e46504c; // "NFPL"
+// also raised when LB_NFPCache changes the form of its keys
+// 2: only NFPs around single parts are kept, a file of version 1 has those around unions too
+const quint32 STORE_VERSION = 2;
+// magic, version
+const qint64 HEADER_SIZE = 8;
+// key size, NFP size, checksum of both
+const qint64 RECORD_HEADER = 12;
+// queued records are written once they add up to this
+const int BATCH_SIZE = 256*1024;
+// the writer compacts a file of at least COMPACT_MIN_SIZE on open if more than this part is garbage
+const double COMPACT_RATIO = 0.5;
+const qint64 COMPACT_MIN_SIZE = 1024*1024;
+// a reader checks whether the writer added records at most this often, a miss meanwhile is computed
+const qint64 REFRESH_INTERVAL_MS = 100;
+
+quint32 ReadU32(const uchar *p)
+{
+    return qFromLittleEndian<quint32>(p);
+}
+
+quint32 Checksum(const QByteArray &data)
+{
+    return qChecksum(data.constData(),uint(data.size()));
+}
+
+}
+
+namespace NFPHandle {
+
+LB_NFPStore::~LB_NFPStore()
+{
+    Close();
+}
+
+bool LB_NFPStore::Open(const QString &aFileName)
+{
+    Close();
+    fileName = aFileName;
+    errorString.clear();
+
+    // the process which gets the lock writes the file, a lock left by a dead process is taken over,
+    // a living writer keeps it however long it runs
+    writeLock.reset(new QLockFile(fileName + ".lock"));
+    writeLock->setStaleLockTime(0);
+    if(!writeLock->tryLock(0))
+        writeLock.reset();
+
+    file.setFileName(fileName);
+    if(!file.open(IsWritable() ? QIODevice::ReadWrite : QIODevice::ReadOnly)) {
+        errorString = QString("cannot open %1").arg(fileName);
+        writeLock.reset();
+        return false;
+    }
+
+    // an empty file is still waiting for its writer
+    if(file.size() > 0) {
+        QByteArray header = file.read(HEADER_SIZE);
+        bool known = header.size() == HEADER_SIZE
+                && ReadU32(reinterpret_cast<const uchar *>(header.constData())) == STORE_MAGIC
+                && ReadU32(reinterpret_cast<const uchar *>(header.constData())+4) == STORE_VERSION;
+        if(!known && !IsWritable()) {
+            errorString = QString("%1 is not an NFP store of version %2").arg(fileName).arg(STORE_VERSION);
+            Close();
+            return false;
+        }
+        // replaced rather than cut, a process still reading the old file keeps it
+        if(!known) {
+            file.close();
+            QFile::remove(fileName);
+            if(!file.open(QIODevice::ReadWrite)) {
+                errorString = QString("cannot open %1").arg(fileName);
+                Close();
+                return false;
+            }
+        }
+    }
+    if(IsWritable() && file.size() == 0 && !WriteHeader()) {
+        Close();
+        return false;
+    }
+
+    QWriteLocker locker(&lock);
+    Refresh();
+    // a record cut off by a crash is written over, the file never gets shorter under a reader
+    end = scanned;
+    const bool compact = IsWritable() && end >= COMPACT_MIN_SIZE && garbage > COMPACT_RATIO*end;
+    locker.unlock();
+
+    // still usable as it is if that fails
+    if(compact)
+        Compact();
+    return true;
+}
+
+void LB_NFPStore::Close()
+{
+    {
+        QMutexLocker flushLocker(&flushMutex);
+        flushing.waitForFinished();
+    }
+
+    QWriteLocker locker(&lock);
+    WritePending();
+    if(mapped)
+        file.unmap(mapped);
+    mapped = nullptr;
+    mappedSize = 0;
+    scanned = 0;
+    end = 0;
+    garbage = 0;
+    index.clear();
+    file.close();
+    writeLock.reset();
+}
+
+bool LB_NFPStore::WriteHeader()
+{
+    uchar header[HEADER_SIZE];
+    qToLittleEndian<quint32>(STORE_MAGIC,header);
+    qToLittleEndian<quint32>(STORE_VERSION,header+4);
+    if(!file.seek(0) || file.write(reinterpret_cast<const char *>(header),HEADER_SIZE) != HEADER_SIZE || !file.flush()) {
+        errorString = QString("cannot write %1").arg(fileName);
+        return false;
+    }
+    return true;
+}
+
+void LB_NFPStore::Refresh()
+{
+    const qint64 size = file.size();
+    if(size > mappedSize) {
+        if(mapped)
+            file.unmap(mapped);
+        mapped = file.map(0,size);
+        mappedSize = mapped ? size : 0;
+        if(!mapped)
+            scanned = 0;
+    }
+    Scan();
+}
+
+bool LB_NFPStore::RefreshDue()
+{
+    const qint64 now = refreshClock.elapsed();
+    const qint64 next = nextRefresh.loadRelaxed();
+    return now >= next && nextRefresh.testAndSetOrdered(next,now + REFRESH_INTERVAL_MS);
+}
+
+void LB_NFPStore::Scan()
+{
+    if(!mapped || mappedSize < HEADER_SIZE)
+        return;
+    if(scanned == 0) {
+        if(ReadU32(mapped) != STORE_MAGIC || ReadU32(mapped+4) != STORE_VERSION)
+            return;
+        scanned = HEADER_SIZE;
+    }
+
+    // a record which doesn't fit or fails its checksum is torn, or still being written
+    qint64 pos = scanned;
+    while(pos + RECORD_HEADER <= mappedSize) {
+        const uchar *p = mapped + pos;
+        const qint64 keySize = ReadU32(p);
+        const qint64 nfpSize = ReadU32(p+4);
+        const qint64 end = pos + RECORD_HEADER + keySize + nfpSize;
+        if(end > mappedSize)
+            break;
+
+        QByteArray body = QByteArray::fromRawData(reinterpret_cast<const char *>(p+RECORD_HEADER),int(keySize+nfpSize));
+        if(Checksum(body) != ReadU32(p+8))
+            break;
+
+        QByteArray key(body.constData(),int(keySize));
+        // the record of a key written again is left over
+        if(index.contains(key))
+            garbage += end - pos;
+        index.insert(key,pos);
+        pos = end;
+    }
+    scanned = pos;
+}
+
+bool LB_NFPStore::Find(const QByteArray &key, QVector<LB_Polygon2D> &nfp)
+{
+    // the end of the record at offset, 0 if it isn't mapped (yet)
+    auto mappedEnd = [this](qint64 offset) -> qint64 {
+        if(offset < 0 || offset + RECORD_HEADER > mappedSize)
+            return 0;
+        const qint64 end = offset + RECORD_HEADER + ReadU32(mapped+offset) + ReadU32(mapped+offset+4);
+        return end <= mappedSize ? end : 0;
+    };
+    auto read = [&nfp](const uchar *p) -> bool {
+        const int keySize = int(ReadU32(p));
+        QByteArray data = QByteArray::fromRawData(reinterpret_cast<const char *>(p+RECORD_HEADER+keySize),int(ReadU32(p+4)));
+        QDataStream in(data);
+        in >> nfp;
+        return in.status() == QDataStream::Ok;
+    };
+
+    {
+        QReadLocker locker(&lock);
+        if(!file.isOpen())
+            return false;
+        qint64 offset = index.value(key,-1);
+        if(mappedEnd(offset) > 0)
+            return read(mapped+offset);
+        // queued, not written yet
+        qint64 queued = pendingIndex.value(key,-1);
+        if(queued >= 0)
+            return read(reinterpret_cast<const uchar *>(pending.constData())+queued);
+        if(offset < 0) {
+            // nobody else adds records to the file of the writer
+            if(IsWritable())
+                return false;
+            // a file which didn't grow is kept mapped, the misses go on under the shared lock
+            if(!RefreshDue() || file.size() <= mappedSize)
+                return false;
+        }
+    }
+
+    QWriteLocker locker(&lock);
+    Refresh();
+    qint64 offset = index.value(key,-1);
+    return mappedEnd(offset) > 0 && read(mapped+offset);
+}
+
+bool LB_NFPStore::Append(const QByteArray &key, const QVector<LB_Polygon2D> &nfp)
+{
+    if(!IsWritable())
+        return false;
+
+    QByteArray data;
+    QDataStream out(&data,QIODevice::WriteOnly);
+    out << nfp;
+
+    QByteArray body = key + data;
+    QByteArray record(int(RECORD_HEADER),0);
+    uchar *p = reinterpret_cast<uchar *>(record.data());
+    qToLittleEndian<quint32>(quint32(key.size()),p);
+    qToLittleEndian<quint32>(quint32(data.size()),p+4);
+    qToLittleEndian<quint32>(Checksum(body),p+8);
+    record.append(body);
+
+    QWriteLocker locker(&lock);
+    if(index.contains(key) || pendingIndex.contains(key))
+        return true;
+    pendingIndex.insert(key,pending.size());
+    pending.append(record);
+    const bool full = pending.size() >= BATCH_SIZE;
+    locker.unlock();
+
+    // a full batch is written by a pool thread, one batch at a time
+    if(full) {
+        QMutexLocker flushLocker(&flushMutex);
+        if(flushing.isFinished())
+            flushing = QtConcurrent::run([this]() {
+                Flush();
+            });
+    }
+    return true;
+}
+
+bool LB_NFPStore::Flush()
+{
+    QWriteLocker locker(&lock);
+    return WritePending();
+}
+
+bool LB_NFPStore::WritePending()
+{
+    if(pending.isEmpty())
+        return true;
+
+    // one write, a reader sees each record whole or not at all (its checksum fails)
+    bool ok = file.seek(end) && file.write(pending) == pending.size() && file.flush();
+    if(ok) {
+        for(auto it = pendingIndex.constBegin(); it != pendingIndex.constEnd(); ++it) {
+            index.insert(it.key(),end+it.value());
+        }
+        end += pending.size();
+    }
+    else {
+        errorString = QString("cannot write %1").arg(fileName);
+    }
+    // dropped on an error as well, the next run computes those NFPs again
+    pending.clear();
+    pendingIndex.clear();
+    return ok;
+}
+
+bool LB_NFPStore::Compact()
+{
+    if(!IsWritable())
+        return false;
+
+    QWriteLocker locker(&lock);
+    WritePending();
+    Refresh();
+
+    QSaveFile out(fileName);
+    if(!out.open(QIODevice::WriteOnly)) {
+        errorString = QString("cannot write %1").arg(fileName);
+        return false;
+    }
+    uchar header[HEADER_SIZE];
+    qToLittleEndian<quint32>(STORE_MAGIC,header);
+    qToLittleEndian<quint32>(STORE_VERSION,header+4);
+    out.write(reinterpret_cast<const char *>(header),HEADER_SIZE);
+    for(auto it = index.constBegin(); it != index.constEnd(); ++it) {
+        const qint64 offset = it.value();
+        if(offset + RECORD_HEADER > mappedSize)
+            continue;
+        const qint64 size = RECORD_HEADER + ReadU32(mapped+offset) + ReadU32(mapped+offset+4);
+        if(offset + size <= mappedSize)
+            out.write(reinterpret_cast<const char *>(mapped+offset),size);
+    }
+
+    // the old file is let go before it is replaced, some systems can't rename over a mapped file
+    if(mapped)
+        file.unmap(mapped);
+    mapped = nullptr;
+    mappedSize = 0;
+    scanned = 0;
+    garbage = 0;
+    index.clear();
+    file.close();
+
+    bool ok = out.commit();
+    if(!ok)
+        errorString = QString("cannot write %1").arg(fileName);
+    if(!file.open(QIODevice::ReadWrite)) {
+        errorString = QString("cannot open %1").arg(fileName);
+        return false;
+    }
+    Refresh();
+    end = scanned;
+    return ok;
+}
+
+int LB_NFPStore::Size() const
+{
+    QReadLocker locker(&lock);
+    return index.size() + pendingIndex.size();
+}
+
+}
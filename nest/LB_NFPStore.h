@@ -0,0 +1,105 @@
+#ifndef LB_NFPSTORE_H
+#define LB_NFPSTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QByteArray>
+#include <QReadWriteLock>
+#include <QScopedPointer>
+#include <QLockFile>
+#include <QMutex>
+#include <QFuture>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+
+#include "LB_Polygon2D.h"
+using namespace Shape2D;
+
+namespace NFPHandle {
+
+// NFPs kept on disk across runs, the backing of LB_NFPCache
+// the file is a header and then records appended one after the other, each one a cache key
+// with its NFPs, so a crash can only cut off the last record, which is dropped on the next open
+// the file is mapped and only an index of the keys is built when it is opened, the NFPs are
+// read when they are asked for
+// any number of processes read the file, the first one to open it also writes it (the others
+// pick up its records as the file grows, the NFPs they compute themselves are not kept), and the
+// process writing can compact the file
+// appended records are queued and written in batches by a pool thread, so the NFP path doesn't
+// wait for the disk; Flush() and Close() write what is left
+class LB_NFPStore
+{
+public:
+    LB_NFPStore() {
+        refreshClock.start();
+    }
+    ~LB_NFPStore();
+    Q_DISABLE_COPY(LB_NFPStore)
+
+    // creates the file if there is none, a file of another version is started over when writable
+    // the writer compacts a file which is mostly repeated records
+    bool Open(const QString &fileName);
+    void Close();
+    bool IsOpen() const {
+        return mapped != nullptr || file.isOpen();
+    }
+    bool IsWritable() const {
+        return !writeLock.isNull();
+    }
+    QString ErrorString() const {
+        return errorString;
+    }
+
+    // the key and the NFPs as LB_NFPCache stores them
+    bool Find(const QByteArray &key, QVector<LB_Polygon2D> &nfp);
+    // queued for the next batch, ignored if the process doesn't write the file or the key is stored already
+    bool Append(const QByteArray &key, const QVector<LB_Polygon2D> &nfp);
+    // writes the queued records now
+    bool Flush();
+
+    // writes the file again with one record per key, which drops torn or repeated records
+    // readers in other processes see the compacted file when they open it again
+    bool Compact();
+
+    int Size() const;
+
+private:
+    bool WriteHeader();
+    // the caller holds lock for writing
+    bool WritePending();
+    // maps the file again if it grew and indexes the records added since the last scan
+    void Refresh();
+    void Scan();
+    // true for one of the threads which ask, at most once per interval
+    bool RefreshDue();
+
+    QString fileName;
+    QFile file;
+    uchar *mapped = nullptr;
+    qint64 mappedSize = 0;
+    // records before this offset are indexed
+    qint64 scanned = 0;
+    // where the writer puts the next record
+    qint64 end = 0;
+    QHash<QByteArray, qint64> index;
+    // bytes of records whose key came again later in the file
+    qint64 garbage = 0;
+
+    // records queued by Append(), the index has their offsets in pending
+    QByteArray pending;
+    QHash<QByteArray, qint64> pendingIndex;
+    // the batch being written, one at a time
+    QMutex flushMutex;
+    QFuture<void> flushing;
+
+    QScopedPointer<QLockFile> writeLock;
+    mutable QReadWriteLock lock;
+    // a reader which misses looks at the size of the file no earlier than this
+    QElapsedTimer refreshClock;
+    QAtomicInteger<qint64> nextRefresh;
+    QString errorString;
+};
+
+}
+
+#endif // LB_NFPSTORE_H
@@ -1,14 +1,50 @@
+QT += concurrent
+
 HEADERS += \
+    $$PWD/LB_AABBTree.h \
     $$PWD/LB_BaseUtil.h \
+    $$PWD/LB_Compactor.h \
     $$PWD/LB_Coord2D.h \
+    $$PWD/LB_LayoutValidator.h \
     $$PWD/LB_NestConfig.h \
+    $$PWD/LB_NestControl.h \
+    $$PWD/LB_NestEngine.h \
+    $$PWD/LB_NestIO.h \
     $$PWD/LB_NestThread.h \
     $$PWD/LB_Rect2D.h \
+    $$PWD/LB_NFPCache.h \
+    $$PWD/LB_NFPCostModel.h \
     $$PWD/LB_NFPHandle.h \
-    $$PWD/LB_Polygon2D.h
+    $$PWD/LB_NFPPrefetch.h \
+    $$PWD/LB_NFPScheduler.h \
+    $$PWD/LB_NFPStore.h \
+    $$PWD/LB_Placement.h \
+    $$PWD/LB_Polygon2D.h \
+    $$PWD/LB_PreparedPolygon.h \
+    $$PWD/LB_RasterExport.h \
+    $$PWD/LB_RectPacker.h \
+    $$PWD/LB_VariantTable.h \
+    $$PWD/LB_VectorExport.h
 
 SOURCES += \
+    $$PWD/LB_AABBTree.cpp \
+    $$PWD/LB_Compactor.cpp \
+    $$PWD/LB_LayoutValidator.cpp \
+    $$PWD/LB_NFPCache.cpp \
+    $$PWD/LB_NFPCostModel.cpp \
     $$PWD/LB_NFPHandle.cpp \
+    $$PWD/LB_NFPPrefetch.cpp \
+    $$PWD/LB_NFPScheduler.cpp \
+    $$PWD/LB_NFPStore.cpp \
     $$PWD/LB_NestConfig.cpp \
+    $$PWD/LB_NestControl.cpp \
+    $$PWD/LB_NestEngine.cpp \
+    $$PWD/LB_NestIO.cpp \
     $$PWD/LB_NestThread.cpp \
-    $$PWD/LB_Polygon2D.cpp
+    $$PWD/LB_Placement.cpp \
+    $$PWD/LB_Polygon2D.cpp \
+    $$PWD/LB_PreparedPolygon.cpp \
+    $$PWD/LB_RasterExport.cpp \
+    $$PWD/LB_RectPacker.cpp \
+    $$PWD/LB_VariantTable.cpp \
+    $$PWD/LB_VectorExport.cpp
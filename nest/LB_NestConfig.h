@@ -5,18 +5,54 @@
 
 namespace NestConfig {
 
+// settings of one nesting job, every engine keeps its own copy
 class LB_NestConfig
 {
 public:
-    static double STRIP_WIDTH;
-    static double STRIP_HEIGHT;
-    static bool ENABLE_ROTATION;
-    static double ITEM_GAP;
+    LB_NestConfig() {}
+
+    double StripWidth() const {
+        return stripWidth;
+    }
+    double StripHeight() const {
+        return stripHeight;
+    }
+    bool EnableRotation() const {
+        return enableRotation;
+    }
+    // with rotation enabled, every part is tried at 0, step, 2*step ... degree
+    // 0 turns each part once to its smallest bounding rectangle instead
+    double RotationStep() const {
+        return rotationStep;
+    }
+    double ItemGap() const {
+        return itemGap;
+    }
 
-    static QString DumpConfig();
+    void SetStripWidth(double val) {
+        stripWidth = val;
+    }
+    void SetStripHeight(double val) {
+        stripHeight = val;
+    }
+    void SetEnableRotation(bool ret) {
+        enableRotation = ret;
+    }
+    void SetRotationStep(double val) {
+        rotationStep = val;
+    }
+    void SetItemGap(double val) {
+        itemGap = val;
+    }
+
+    QString DumpConfig() const;
 
 private:
-    LB_NestConfig() {}
+    double stripWidth = 1000;
+    double stripHeight = 1000;
+    bool enableRotation = true;
+    double rotationStep = 0;
+    double itemGap = 0;
 };
 
 }
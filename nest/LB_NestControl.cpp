@@ -0,0 +1,42 @@
+#include "LB_NestControl.h"
+
+void LB_NestControl::Pause()
+{
+    QMutexLocker locker(&aMutex);
+    paused.storeRelease(1);
+}
+
+void LB_NestControl::Resume()
+{
+    QMutexLocker locker(&aMutex);
+    paused.storeRelease(0);
+    waitCondition.wakeAll();
+}
+
+void LB_NestControl::Cancel()
+{
+    QMutexLocker locker(&aMutex);
+    canceled.storeRelease(1);
+    waitCondition.wakeAll();
+}
+
+void LB_NestControl::Reset()
+{
+    QMutexLocker locker(&aMutex);
+    paused.storeRelease(0);
+    canceled.storeRelease(0);
+    waitCondition.wakeAll();
+}
+
+bool LB_NestControl::CheckPoint()
+{
+    // fast path, nothing requested
+    if(!paused.loadAcquire() && !canceled.loadAcquire())
+        return true;
+
+    QMutexLocker locker(&aMutex);
+    while(paused.loadAcquire() && !canceled.loadAcquire()) {
+        waitCondition.wait(&aMutex);
+    }
+    return !canceled.loadAcquire();
+}
@@ -0,0 +1,42 @@
+#ifndef LB_NESTCONTROL_H
+#define LB_NESTCONTROL_H
+
+#include <QAtomicInt>
+#include <QWaitCondition>
+#include <QMutex>
+
+// pause/cancel switches shared between a running nest and the threads driving it
+// the worker calls CheckPoint() once per orbit step of NoFitPolygon and once per part,
+// so a request takes effect within one orbit step; checking costs two atomic loads
+class LB_NestControl
+{
+public:
+    LB_NestControl() {}
+
+    void Pause();
+    void Resume();
+    // stops the nest for good, the engine returns with what has been placed so far
+    void Cancel();
+    // clears both switches before a new run
+    void Reset();
+
+    bool IsPaused() const {
+        return paused.loadAcquire() != 0;
+    }
+    bool IsCanceled() const {
+        return canceled.loadAcquire() != 0;
+    }
+
+    // blocks while paused, returns false once canceled
+    bool CheckPoint();
+
+private:
+    QAtomicInt paused;
+    QAtomicInt canceled;
+
+    // only used to sleep while paused, the flags are changed under it so no wake-up gets lost
+    QMutex aMutex;
+    QWaitCondition waitCondition;
+};
+
+#endif // LB_NESTCONTROL_H
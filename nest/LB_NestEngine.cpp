@@ -0,0 +1,555 @@
+#include "LB_NestEngine.h"
+#include "LB_NestIO.h"
+#include "LB_Compactor.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QThread>
+
+namespace {
+
+const quint32 CHECKPOINT_MAGIC = 0x4e465043; // "NFPC"
+const quint32 CHECKPOINT_VERSION = 4;
+// a rotated part counts as a rectangle within this tolerance
+const double RECT_TOL = 1e-6;
+
+}
+
+LB_NestEngine::LB_NestEngine(const LB_NestConfig &aConfig, QObject *parent) :
+    QObject(parent),
+    config(aConfig),
+    cache(new LB_NFPCache),
+    costModel(new LB_NFPCostModel),
+    control(new LB_NestControl)
+{
+}
+
+void LB_NestEngine::Run()
+{
+    if(!runCache)
+        runCache.reset(new LB_NFPCache);
+    Prepare();
+    MakeBaseline();
+    OpenVectorExport();
+    PackRectangles();
+    Nest();
+    runCache.reset();
+}
+
+bool LB_NestEngine::Resume(const QString &fileName)
+{
+    if(!LoadCheckpoint(fileName)) {
+        runCache.reset();
+        return false;
+    }
+    if(!runCache)
+        runCache.reset(new LB_NFPCache);
+    MakeBaseline();
+    OpenVectorExport();
+
+    // let the receivers rebuild what had been placed before the checkpoint
+    // a strip held for compaction is sent when it is done
+    int ready = placements.size();
+    if(compactBudget > 0 && cursor > 0) {
+        while(ready > 0 && placements[ready-1].stripID == stripNb-1)
+            ready--;
+    }
+    published = 0;
+    Flush(ready);
+
+    Nest();
+    runCache.reset();
+    return true;
+}
+
+void LB_NestEngine::Prepare()
+{
+    parts = polygons;
+    rotations.fill(0,parts.size());
+    for(int ctr = 0; ctr < parts.size(); ++ctr) {
+        parts[ctr].SetPartID(ctr);
+    }
+
+    // deal with config
+    if(config.EnableRotation() && config.RotationStep() <= 0)
+        RotateToMinBounds();
+    if(config.ItemGap() != 0) {
+        for(int ctr = 0; ctr < parts.size(); ++ctr) {
+            parts[ctr] = parts[ctr].Shrinking(-config.ItemGap());
+        }
+    }
+    BuildVariants();
+
+    stripNb = 0;
+    cursor = 0;
+    last.clear();
+    placements.clear();
+    published = 0;
+    operate.clear();
+    unPlaced = parts;
+
+    // 1.let polygons in an order
+    SortByAreaDecreasing();
+}
+
+void LB_NestEngine::BuildVariants()
+{
+    if(config.EnableRotation())
+        variants.Build(parts,LB_VariantTable::Angles(config.RotationStep()),threaded);
+    else
+        variants.Build(parts,LB_VariantTable::Angles(0),threaded);
+}
+
+void LB_NestEngine::PackRectangles()
+{
+    // the rectangles don't need any NFP, they are packed on strips of their own
+    QVector<LB_PackRect> rects;
+    QVector<LB_Polygon2D> others;
+    for(int ctr = 0; ctr < unPlaced.size(); ++ctr) {
+        LB_Polygon2D &aPart = unPlaced[ctr];
+        if(aPart.IsRectangle(RECT_TOL)) {
+            LB_PackRect aRect;
+            aRect.id = aPart.PartID();
+            aRect.width = aPart.Width();
+            aRect.height = aPart.Height();
+            rects.append(aRect);
+        }
+        else {
+            others.append(aPart);
+        }
+    }
+    if(rects.isEmpty())
+        return;
+
+    LB_RectPacker packer(config.StripWidth(),config.StripHeight(),config.EnableRotation());
+    QVector<LB_PackedRect> packed = packer.PackBest(rects);
+
+    // with other parts left, the last rectangle strip is not full, let the nest fill it
+    int lastBin = packer.BinNumber();
+    if(!others.isEmpty())
+        lastBin--;
+
+    QVector<bool> done(parts.size(),false);
+    foreach(const LB_PackedRect &aPacked,packed) {
+        if(aPacked.bin >= lastBin)
+            continue;
+
+        Publish(PackedPlacement(aPacked,stripNb));
+        done[aPacked.id] = true;
+    }
+    stripNb += qMax(0,lastBin);
+    // never compacted, no need to hold them
+    Flush(placements.size());
+
+    // keep the order of the rest
+    operate.clear();
+    foreach(const LB_Polygon2D &aPart,unPlaced) {
+        if(!done[aPart.PartID()])
+            operate.append(aPart);
+    }
+    unPlaced.swap(operate);
+    operate.clear();
+}
+
+void LB_NestEngine::MakeBaseline()
+{
+    // bottom-left on a skyline by the bounding boxes: valid at once and cheap
+    QVector<LB_PackRect> rects;
+    rects.reserve(parts.size());
+    for(int ctr = 0; ctr < parts.size(); ++ctr) {
+        LB_PackRect aRect;
+        aRect.id = ctr;
+        aRect.width = parts[ctr].Width();
+        aRect.height = parts[ctr].Height();
+        rects.append(aRect);
+    }
+
+    LB_RectPacker packer(config.StripWidth(),config.StripHeight(),config.EnableRotation());
+    QVector<LB_PackedRect> packed = packer.Pack(rects,LB_RectPacker::Skyline);
+
+    baseline.clear();
+    baseline.reserve(packed.size());
+    foreach(const LB_PackedRect &aPacked,packed) {
+        baseline.append(PackedPlacement(aPacked,0));
+    }
+    baselineStripNb = packer.BinNumber();
+
+    emit BaselineReady();
+}
+
+LB_Placement LB_NestEngine::PackedPlacement(const LB_PackedRect &packed, int firstStrip) const
+{
+    // the translation moving the bounds of the (turned) part onto the packed corner
+    LB_Polygon2D aPart = parts[packed.id];
+    if(packed.rotated)
+        aPart.Rotate(90);
+
+    LB_Placement placement;
+    placement.partID = packed.id;
+    placement.stripID = firstStrip + packed.bin;
+    placement.rotation = rotations[packed.id] + (packed.rotated ? 90 : 0);
+    placement.dx = packed.x - aPart.X();
+    placement.dy = packed.y - aPart.Y();
+    return placement;
+}
+
+bool LB_NestEngine::UsesBaseline() const
+{
+    // a part larger than a strip is missing from the baseline
+    if(baseline.size() != parts.size())
+        return false;
+    return !IsFinished() || baselineStripNb < stripNb;
+}
+
+QVector<LB_Polygon2D> LB_NestEngine::Shapes(const QVector<LB_Placement> &records) const
+{
+    QVector<LB_Polygon2D> result;
+    result.reserve(records.size());
+    foreach(const LB_Placement &aPlacement,records) {
+        result.append(aPlacement.Apply(polygons[aPlacement.partID]));
+    }
+    return result;
+}
+
+void LB_NestEngine::OpenVectorExport()
+{
+    if(!vectorFile.isEmpty())
+        vectorExport.Open(vectorFile,config,polygons);
+}
+
+void LB_NestEngine::Publish(const LB_Placement &placement)
+{
+    placements.append(placement);
+    if(compactBudget == 0)
+        Flush(placements.size());
+}
+
+void LB_NestEngine::Flush(int end)
+{
+    for(;published<end;++published) {
+        Emit(placements[published]);
+    }
+}
+
+void LB_NestEngine::Emit(const LB_Placement &placement)
+{
+    if(!vectorFile.isEmpty())
+        vectorExport.Add(placement);
+    if(!ring)
+        return;
+
+    // a full ring waits for the consumer, unless the nest is being stopped
+    while(!ring->Push(placement)) {
+        if(control->IsCanceled())
+            return;
+        QThread::msleep(1);
+    }
+    if(ring->RequestNotify())
+        emit PlacementsReady();
+}
+
+void LB_NestEngine::CompactStrip()
+{
+    // the placements of the strip just closed are the last ones
+    int first = placements.size();
+    while(first > 0 && placements[first-1].stripID == stripNb-1)
+        first--;
+
+    // the parts as nested, grown by the gap, so the gap is kept
+    QVector<LB_Polygon2D> strip;
+    strip.reserve(placements.size()-first);
+    for(int k=first;k<placements.size();++k) {
+        LB_Polygon2D aPart = NestedShape(placements[k]);
+        aPart.Translate(placements[k].dx,placements[k].dy);
+        strip.append(aPart);
+    }
+
+    LB_Compactor compactor(config.StripWidth(),config.StripHeight());
+    if(compactor.Compact(strip,compactBudget,control.data()) == 0)
+        return;
+
+    for(int k=first;k<placements.size();++k) {
+        const LB_Polygon2D &moved = strip[k-first];
+        const LB_Polygon2D aPart = NestedShape(placements[k]);
+        placements[k].dx = moved[0].X() - aPart[0].X();
+        placements[k].dy = moved[0].Y() - aPart[0].Y();
+    }
+}
+
+void LB_NestEngine::Nest()
+{
+    const double stripWid = config.StripWidth();
+    const double stripHei = config.StripHeight();
+
+    checkpointTimer.start();
+
+    while(!unPlaced.isEmpty())
+    {
+        if(!control->CheckPoint())
+            break;
+
+        if(cursor == 0) {
+            stripNb++;
+
+            // 2.set the first locatioin
+            unPlaced[0].SetLocation(0,0);
+            unPlaced[0].SetID(stripNb-1);
+            Publish(MakePlacement(unPlaced[0],variants.VariantID(unPlaced[0].PartID(),0)));
+
+            last = unPlaced[0];
+            operate.clear();
+            cursor = 1;
+        }
+
+        // 3.place the other polygons
+        for(;cursor<unPlaced.size();++cursor) {
+
+            CheckpointIfDue();
+
+            if(control->IsPaused() && !checkpointFile.isEmpty())
+                SaveCheckpoint(checkpointFile);
+            if(!control->CheckPoint())
+                break;
+
+            const LB_Polygon2D &aPart = unPlaced[cursor];
+
+            // every orientation of the part is tried, the most left position of them wins
+            // their NFPs don't depend on each other and are computed together
+            // after the first part last is the union of the strip, which no other job meets
+            nfpTasks.resize(variants.Count());
+            for(int k=0;k<variants.Count();++k) {
+                nfpTasks[k].A = &last;
+                nfpTasks[k].shared = last.PartID() >= 0;
+                nfpTasks[k].B = &variants.Variant(variants.VariantID(aPart.PartID(),k));
+            }
+            LB_NFPScheduler(cache.data(),runCache.data(),costModel.data(),control.data(),threaded).Run(nfpTasks);
+            // stopped in the middle of the orbit, the part is tried again on resume
+            if(control->IsCanceled())
+                break;
+
+            int bestVariant = -1;
+            LB_Coord2D bestPosition;
+            int left = stripWid;
+            for(int k=0;k<variants.Count();++k) {
+                const QVector<LB_Polygon2D> &NFPS = nfpTasks[k].nfp;
+                if(NFPS.isEmpty())
+                    continue;
+
+                const int id = variants.VariantID(aPart.PartID(),k);
+                LB_Polygon2D orb = variants.Variant(id);
+
+                // iterate the nfp, to find the most left position to place the polygon
+                const LB_Polygon2D &nfp = NFPS.first();
+                for(int i=0;i<nfp.size();++i) {
+                    orb.SetPosition(nfp[i],0);
+                    if(orb.X()<0 || orb.X()+orb.Width()>stripWid)
+                        continue;
+
+                    if(orb.Y()<0 || orb.Y()+orb.Height()>stripHei)
+                        continue;
+
+                    if(orb.X()<left)
+                    {
+                        left = orb.X();
+                        bestVariant = id;
+                        bestPosition = nfp[i];
+                    }
+                }
+            }
+
+            if(bestVariant != -1) {
+                LB_Polygon2D orb = variants.Variant(bestVariant);
+                orb.SetPosition(bestPosition,0);
+                orb.SetID(stripNb-1);
+                Publish(MakePlacement(orb,bestVariant));
+
+                // get the hull of the polygons which have been placed
+                bool ret1 = orb.IsAntiClockWise();
+                bool ret2 = last.IsAntiClockWise();
+                if(ret1 != ret2) {
+                    orb.Reverse();
+                }
+
+                last = last.United(orb);
+            }
+            else {
+                operate.append(aPart);
+            }
+        }
+        if(control->IsCanceled())
+            break;
+
+        if(compactBudget > 0)
+            CompactStrip();
+        Flush(placements.size());
+
+        unPlaced.swap(operate);
+        cursor = 0;
+    }
+    // a strip stopped before its compaction goes out as it is
+    Flush(placements.size());
+
+    if(!vectorFile.isEmpty())
+        vectorExport.Finish();
+
+    emit NestEnd();
+}
+
+bool LB_NestEngine::SaveCheckpoint(const QString &fileName) const
+{
+    // written aside and renamed, a crash while saving keeps the previous checkpoint
+    QSaveFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out << CHECKPOINT_MAGIC << CHECKPOINT_VERSION << config << polygons << parts << rotations
+        << qint32(stripNb) << qint32(cursor) << last << unPlaced << operate << placements;
+    // no NFPs, the cache is shared with other jobs; the store or the orbit gives them again
+
+    if(out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+bool LB_NestEngine::LoadCheckpoint(const QString &fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if(magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION)
+        return false;
+
+    LB_NestConfig aConfig;
+    QVector<LB_Polygon2D> aPolygons, aParts;
+    QVector<double> aRotations;
+    qint32 aStripNb = 0, aCursor = 0;
+    LB_Polygon2D aLast;
+    QVector<LB_Polygon2D> anUnPlaced, anOperate;
+    QVector<LB_Placement> aPlacements;
+    in >> aConfig >> aPolygons >> aParts >> aRotations
+       >> aStripNb >> aCursor >> aLast >> anUnPlaced >> anOperate >> aPlacements;
+    if(in.status() != QDataStream::Ok || aCursor < 0 || aCursor > anUnPlaced.size())
+        return false;
+
+    config = aConfig;
+    polygons = aPolygons;
+    parts = aParts;
+    rotations = aRotations;
+    BuildVariants();
+    stripNb = aStripNb;
+    cursor = aCursor;
+    last = aLast;
+    unPlaced = anUnPlaced;
+    operate = anOperate;
+    placements = aPlacements;
+    return true;
+}
+
+void LB_NestEngine::CheckpointIfDue()
+{
+    if(checkpointFile.isEmpty() || checkpointTimer.elapsed() < checkpointInterval)
+        return;
+
+    SaveCheckpoint(checkpointFile);
+    checkpointTimer.restart();
+}
+
+void LB_NestEngine::PauseNest()
+{
+    control->Pause();
+}
+
+void LB_NestEngine::ResumeNest()
+{
+    control->Resume();
+}
+
+void LB_NestEngine::StopNest()
+{
+    control->Cancel();
+}
+
+void LB_NestEngine::SortByWidthDecreasing()
+{
+    for(int ctr = 0; ctr < unPlaced.size(); ++ctr)
+    {
+        double maxWid = unPlaced[ctr].Bounds().Width();
+        int maxIndex = ctr;
+        for(int ctr2 = ctr + 1; ctr2 < unPlaced.size(); ++ctr2)
+        {
+            double wid = unPlaced[ctr2].Bounds().Width();
+            if(wid > maxWid)
+            {
+                maxWid = wid;
+                maxIndex = ctr2;
+            }
+        }
+        LB_Polygon2D temp = unPlaced[ctr];
+        unPlaced[ctr] = unPlaced[maxIndex];
+        unPlaced[maxIndex] = temp;
+    }
+}
+
+void LB_NestEngine::SortByAreaDecreasing()
+{
+    for(int ctr = 0; ctr < unPlaced.size(); ++ctr)
+    {
+        double maxArea = abs(unPlaced[ctr].Area());
+        int maxIndex = ctr;
+        for(int ctr2 = ctr + 1; ctr2 < unPlaced.size(); ++ctr2)
+        {
+            double area = abs(unPlaced[ctr2].Area());
+            if(area > maxArea)
+            {
+                maxArea = area;
+                maxIndex = ctr2;
+            }
+        }
+        LB_Polygon2D temp = unPlaced[ctr];
+        unPlaced[ctr] = unPlaced[maxIndex];
+        unPlaced[maxIndex] = temp;
+    }
+}
+
+void LB_NestEngine::RotateToMinBounds()
+{
+    for(int ctr = 0; ctr < parts.size(); ++ctr) {
+        rotations[ctr] = parts[ctr].RotateToMinBndRect();
+    }
+}
+
+LB_Placement LB_NestEngine::MakePlacement(const LB_Polygon2D &poly, int variantID) const
+{
+    // the offset of any vertex from the variant is the translation
+    const LB_Polygon2D &variant = variants.Variant(variantID);
+
+    LB_Placement placement;
+    placement.partID = poly.PartID();
+    placement.stripID = poly.ID();
+    placement.rotation = rotations[poly.PartID()] + variants.Angle(variantID);
+    placement.dx = poly[0].X() - variant[0].X();
+    placement.dy = poly[0].Y() - variant[0].Y();
+    return placement;
+}
+
+LB_Polygon2D LB_NestEngine::NestedShape(const LB_Placement &placement) const
+{
+    const double turn = placement.rotation - rotations[placement.partID];
+    int id = variants.FindVariant(placement.partID,turn);
+    if(id != -1)
+        return variants.Variant(id);
+
+    // a turn no variant has, like a packed rectangle's
+    LB_Polygon2D aPart = parts[placement.partID];
+    if(turn != 0)
+        aPart.Rotate(turn);
+    return aPart;
+}
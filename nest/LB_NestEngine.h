@@ -0,0 +1,231 @@
+#ifndef LB_NESTENGINE_H
+#define LB_NESTENGINE_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+
+#include "LB_NFPHandle.h"
+#include "LB_NFPCache.h"
+#include "LB_NFPScheduler.h"
+#include "LB_NestConfig.h"
+#include "LB_NestControl.h"
+#include "LB_Placement.h"
+#include "LB_VectorExport.h"
+#include "LB_RectPacker.h"
+#include "LB_VariantTable.h"
+using namespace NFPHandle;
+using namespace NestConfig;
+using namespace Shape2D;
+
+// one nesting job: owns its config, its working buffers and its NFP cache
+// engines don't share any state, so several of them can run at the same time in different threads
+class LB_NestEngine : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LB_NestEngine(const LB_NestConfig &aConfig = LB_NestConfig(), QObject *parent = nullptr);
+
+    void Run();
+
+    // continue a job from a checkpoint file, the placements made before are published again first
+    bool Resume(const QString &fileName);
+
+    // while running, write the full state to fileName every intervalMs (and when paused)
+    // an empty name switches checkpoints off
+    void SetCheckpoint(const QString &fileName, int intervalMs) {
+        checkpointFile = fileName;
+        checkpointInterval = intervalMs;
+    }
+    bool SaveCheckpoint(const QString &fileName) const;
+
+    // after each strip, slide its parts left and down for at most budgetMs, 0 switches it off
+    // a strip is then published once it is compacted instead of part by part
+    void SetCompaction(int budgetMs) {
+        compactBudget = budgetMs;
+    }
+
+    // while running, write every finished strip as vectors (see LB_VectorExport)
+    // an empty name switches it off
+    void SetVectorExport(const QString &fileName) {
+        vectorFile = fileName;
+    }
+    const LB_VectorExport &VectorExport() const {
+        return vectorExport;
+    }
+
+    const LB_NestConfig &Config() const {
+        return config;
+    }
+    void SetConfig(const LB_NestConfig &aConfig) {
+        config = aConfig;
+    }
+
+    // the parts of the job, LB_Placement::partID is an index into them
+    // the polygons stay shared with the caller's, their cached properties are filled here
+    // so the run doesn't write into them
+    void SetPolygons(const QVector<LB_Polygon2D> &polygonVec) {
+        polygons = polygonVec;
+        foreach(const LB_Polygon2D &aPolygon,polygons) {
+            aPolygon.UpdateCache();
+        }
+    }
+    void AppendPolygon(const LB_Polygon2D &aPolygon) {
+        aPolygon.UpdateCache();
+        polygons.push_back(aPolygon);
+    }
+    const QVector<LB_Polygon2D> &Polygons() const {
+        return polygons;
+    }
+
+    // every placement is also pushed to this ring, PlacementsReady() tells the consumer to drain it
+    void SetPlacementRing(const QSharedPointer<LB_PlacementRing> &aRing) {
+        ring = aRing;
+    }
+
+    // the cache may be shared between engines, by default every engine has its own
+    QSharedPointer<LB_NFPCache> Cache() const {
+        return cache;
+    }
+    void SetCache(const QSharedPointer<LB_NFPCache> &aCache) {
+        cache = aCache;
+    }
+    // the NFPs against the unions of placed parts, which only this job meets, kept apart from the
+    // shared cache and dropped when the run ends; by default every run starts an empty one,
+    // the prefetch of the same job hands on the one it filled
+    void SetRunCache(const QSharedPointer<LB_NFPCache> &aCache) {
+        runCache = aCache;
+    }
+    // orders the NFPs computed in parallel, calibrated by them, shared like the cache
+    QSharedPointer<LB_NFPCostModel> CostModel() const {
+        return costModel;
+    }
+    void SetCostModel(const QSharedPointer<LB_NFPCostModel> &aModel) {
+        costModel = aModel;
+    }
+
+    // false runs the NFP batches and the rotations in the calling thread, for a background run
+    // which mustn't take the threads of the global pool from the nests in the foreground
+    void SetThreaded(bool on) {
+        threaded = on;
+    }
+
+    // pause/cancel switches, the owner resets them before a run
+    QSharedPointer<LB_NestControl> Control() const {
+        return control;
+    }
+    void SetControl(const QSharedPointer<LB_NestControl> &aControl) {
+        control = aControl;
+    }
+
+    // results of the last run, partial if it was stopped
+    int StripNumber() const {
+        return stripNb;
+    }
+    const QVector<LB_Placement> &Placements() const {
+        return placements;
+    }
+    // the placed shapes, built from the placements
+    QVector<LB_Polygon2D> Placed() const {
+        return Shapes(placements);
+    }
+    QVector<LB_Polygon2D> Shapes(const QVector<LB_Placement> &records) const;
+    bool IsFinished() const {
+        return unPlaced.isEmpty();
+    }
+
+    // every part placed by its bounding box, ready before the nest starts (BaselineReady())
+    // its strip number is an upper bound for the nest
+    const QVector<LB_Placement> &Baseline() const {
+        return baseline;
+    }
+    int BaselineStripNumber() const {
+        return baselineStripNb;
+    }
+    // the baseline replaces a nest which was stopped or used more strips
+    bool UsesBaseline() const;
+    const QVector<LB_Placement> &BestPlacements() const {
+        return UsesBaseline() ? baseline : placements;
+    }
+    int BestStripNumber() const {
+        return UsesBaseline() ? baselineStripNb : stripNb;
+    }
+
+    void PauseNest();
+    void ResumeNest();
+    // may be called from any thread, Run() returns within one orbit step
+    void StopNest();
+
+protected:
+    void Prepare();
+    void MakeBaseline();
+    void PackRectangles();
+    LB_Placement PackedPlacement(const LB_PackedRect &packed, int firstStrip) const;
+    void Nest();
+    bool LoadCheckpoint(const QString &fileName);
+    void CheckpointIfDue();
+    void OpenVectorExport();
+    void BuildVariants();
+    // poly is the variant variantID moved around
+    LB_Placement MakePlacement(const LB_Polygon2D &poly, int variantID) const;
+    // the part of placement as it is nested, turned but not moved
+    LB_Polygon2D NestedShape(const LB_Placement &placement) const;
+    void Publish(const LB_Placement &placement);
+    // sends placements[published,end) to the ring and the vector export
+    void Flush(int end);
+    void Emit(const LB_Placement &placement);
+    void CompactStrip();
+
+    void SortByWidthDecreasing();
+    void SortByAreaDecreasing();
+    void RotateToMinBounds();
+
+private:
+    LB_NestConfig config;
+    QVector<LB_Polygon2D> polygons;
+    QSharedPointer<LB_NFPCache> cache;
+    QSharedPointer<LB_NFPCache> runCache;
+    QSharedPointer<LB_NFPCostModel> costModel;
+    QSharedPointer<LB_PlacementRing> ring;
+
+    // the parts as they are nested (rotated, grown by the gap), indexed like polygons
+    QVector<LB_Polygon2D> parts;
+    QVector<double> rotations;
+    // the parts in every orientation the nest tries, rebuilt from parts and the config
+    LB_VariantTable variants;
+
+    // working buffers, kept to reuse their memory between strips and runs
+    QVector<LB_Polygon2D> unPlaced;
+    QVector<LB_Polygon2D> operate;
+    QVector<LB_NFPTask> nfpTasks;
+
+    // state of the running job, everything a checkpoint needs to continue
+    // cursor is the index in unPlaced of the next part to place in the current strip, 0 if the strip isn't started
+    int stripNb = 0;
+    int cursor = 0;
+    LB_Polygon2D last;
+    QVector<LB_Placement> placements;
+    // placements already sent to the receivers
+    int published = 0;
+    int compactBudget = 0;
+    bool threaded = true;
+
+    QVector<LB_Placement> baseline;
+    int baselineStripNb = 0;
+
+    QString checkpointFile;
+    int checkpointInterval = 0;
+    QElapsedTimer checkpointTimer;
+
+    QString vectorFile;
+    LB_VectorExport vectorExport;
+
+    QSharedPointer<LB_NestControl> control;
+
+signals:
+    void BaselineReady();
+    void PlacementsReady();
+    void NestEnd();
+};
+
+#endif // LB_NESTENGINE_H
@@ -0,0 +1,137 @@
+#include "LB_NestIO.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTextStream>
+#include <QStringList>
+
+namespace Shape2D {
+
+QDataStream &operator<<(QDataStream &out, const LB_Coord2D &pnt)
+{
+    out << pnt.X() << pnt.Y();
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, LB_Coord2D &pnt)
+{
+    double x = 0, y = 0;
+    in >> x >> y;
+    pnt = LB_Coord2D(x,y);
+    return in;
+}
+
+QDataStream &operator<<(QDataStream &out, const LB_Polygon2D &poly)
+{
+    out << qint32(poly.ID()) << qint32(poly.PartID()) << qint32(poly.size());
+    for(int i=0;i<poly.size();++i) {
+        out << poly[i];
+    }
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, LB_Polygon2D &poly)
+{
+    qint32 id = -1, partID = -1, size = 0;
+    in >> id >> partID >> size;
+
+    poly.clear();
+    if(in.status() != QDataStream::Ok || size < 0)
+        return in;
+
+    poly.reserve(size);
+    for(int i=0;i<size;++i) {
+        LB_Coord2D pnt;
+        in >> pnt;
+        poly.push_back(pnt);
+    }
+    poly.SetID(id);
+    poly.SetPartID(partID);
+    return in;
+}
+
+}
+
+namespace NestConfig {
+
+QDataStream &operator<<(QDataStream &out, const LB_NestConfig &config)
+{
+    out << config.StripWidth() << config.StripHeight() << config.EnableRotation() << config.RotationStep() << config.ItemGap();
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, LB_NestConfig &config)
+{
+    double width = 0, height = 0, step = 0, gap = 0;
+    bool rotation = false;
+    in >> width >> height >> rotation >> step >> gap;
+    config.SetStripWidth(width);
+    config.SetStripHeight(height);
+    config.SetEnableRotation(rotation);
+    config.SetRotationStep(step);
+    config.SetItemGap(gap);
+    return in;
+}
+
+}
+
+QDataStream &operator<<(QDataStream &out, const LB_Placement &placement)
+{
+    out << qint32(placement.partID) << qint32(placement.stripID)
+        << placement.rotation << placement.dx << placement.dy;
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, LB_Placement &placement)
+{
+    qint32 partID = -1, stripID = -1;
+    in >> partID >> stripID >> placement.rotation >> placement.dx >> placement.dy;
+    placement.partID = partID;
+    placement.stripID = stripID;
+    return in;
+}
+
+namespace NestIO {
+
+using namespace Shape2D;
+
+QVector<LB_Polygon2D> LoadPolygons(const QString &fileName)
+{
+    QVector<LB_Polygon2D> input;
+
+    QFile polyFile(fileName);
+    QTextStream aStream(&polyFile);
+
+    if(polyFile.open(QIODevice::ReadOnly))
+    {
+        while(!aStream.atEnd())
+        {
+            QString line = aStream.readLine();
+            QStringList points = line.split(";");
+            LB_Polygon2D aPoly;
+            for(int ctr = 0; ctr < points.size(); ++ctr)
+            {
+                QStringList coordinates = points[ctr].split(",");
+                if(coordinates.size() != 2)
+                    continue;
+
+                double x = coordinates[0].toDouble();
+                double y = coordinates[1].toDouble();
+                aPoly.push_back(LB_Coord2D(x,y));
+            }
+            input.push_back(aPoly);
+        }
+    }
+
+    polyFile.close();
+    return input;
+}
+
+QString StripFileName(const QString &fileName, int index)
+{
+    QFileInfo info(fileName);
+    return info.dir().filePath(QString("%1_%2.%3").arg(info.completeBaseName()).arg(index).arg(info.suffix()));
+}
+
+}
@@ -0,0 +1,42 @@
+#ifndef LB_NESTIO_H
+#define LB_NESTIO_H
+
+#include <QDataStream>
+
+#include "LB_Polygon2D.h"
+#include "LB_NestConfig.h"
+#include "LB_Placement.h"
+
+// binary form of the nesting data, used to pass jobs between processes
+namespace Shape2D {
+
+QDataStream &operator<<(QDataStream &out, const LB_Coord2D &pnt);
+QDataStream &operator>>(QDataStream &in, LB_Coord2D &pnt);
+
+// the strip and part ids are kept, the bounds are rebuilt on reading
+QDataStream &operator<<(QDataStream &out, const LB_Polygon2D &poly);
+QDataStream &operator>>(QDataStream &in, LB_Polygon2D &poly);
+
+}
+
+namespace NestConfig {
+
+QDataStream &operator<<(QDataStream &out, const LB_NestConfig &config);
+QDataStream &operator>>(QDataStream &in, LB_NestConfig &config);
+
+}
+
+QDataStream &operator<<(QDataStream &out, const LB_Placement &placement);
+QDataStream &operator>>(QDataStream &in, LB_Placement &placement);
+
+namespace NestIO {
+
+// reads a .fply file, one polygon per line as "x1,y1;x2,y2;..."
+QVector<Shape2D::LB_Polygon2D> LoadPolygons(const QString &fileName);
+
+// the file of one strip when a result is written per strip: "a/b.png" -> "a/b_3.png"
+QString StripFileName(const QString &fileName, int index);
+
+}
+
+#endif // LB_NESTIO_H
@@ -2,13 +2,11 @@
 #define LB_NESTTHREAD_H
 
 #include <QThread>
-#include <QWaitCondition>
-#include <QMutex>
 
-#include "LB_NFPHandle.h"
-using namespace NFPHandle;
-using namespace Shape2D;
+#include "LB_NestEngine.h"
+#include "LB_LayoutValidator.h"
 
+// runs a LB_NestEngine in a background thread and forwards its signals
 class LB_NestThread : public QThread
 {
     Q_OBJECT
@@ -17,32 +15,53 @@ public:
 
     void run() override;
 
+    void SetConfig(const LB_NestConfig &aConfig) {
+        engine.SetConfig(aConfig);
+    }
     void SetPolygons(const QVector<LB_Polygon2D> &polygonVec) {
-        polygons = polygonVec;
+        engine.SetPolygons(polygonVec);
     }
     void AppendPolygon(const LB_Polygon2D &aPolygon) {
-        polygons.push_back(aPolygon);
+        engine.AppendPolygon(aPolygon);
+    }
+
+    void SetCheckpoint(const QString &fileName, int intervalMs) {
+        engine.SetCheckpoint(fileName,intervalMs);
+    }
+    void SetCompaction(int budgetMs) {
+        engine.SetCompaction(budgetMs);
+    }
+    // the next start continues from this checkpoint instead of nesting the polygons, once
+    void SetResumeFile(const QString &fileName) {
+        resumeFile = fileName;
     }
 
+    // consumer side of the placement ring, call it after PlacementsReady() and NestEnd()
+    int TakePlacements(QVector<LB_Placement> &out) {
+        return ring->Drain(out);
+    }
+
+    LB_NestEngine *Engine() {
+        return &engine;
+    }
+
+    // clears a previous pause/stop and starts the thread
+    void StartNest();
     void PauseNest();
     void ResumeNest();
-
-protected:
-    void SortByWidthDecreasing();
-    void SortByAreaDecreasing();
-    void RotateToMinBounds();
+    void StopNest();
 
 private:
-    QVector<LB_Polygon2D> polygons;
-
-    bool doNestWait = false;
-    QWaitCondition waitCondition;
-    QMutex aMutex;
+    LB_NestEngine engine;
+    QSharedPointer<LB_PlacementRing> ring;
+    QString resumeFile;
 
 signals:
-    void AddItem(LB_Polygon2D poly);
-    void AddStrip();
-    void NestEnd();
+    void BaselineReady();
+    void PlacementsReady();
+    // after the run, with the check of the layout it ends with (BestPlacements()),
+    // made in this thread so a large layout doesn't block the receiver
+    void NestEnd(const LB_ValidationReport &report);
 };
 
 #endif // LB_NESTTHREAD_H
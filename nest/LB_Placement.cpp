@@ -0,0 +1,52 @@
+#include "LB_Placement.h"
+
+LB_Polygon2D LB_Placement::Apply(const LB_Polygon2D &part) const
+{
+    LB_Polygon2D poly(part);
+    if(rotation != 0)
+        poly.Rotate(rotation);
+    poly.Translate(dx,dy);
+    poly.SetID(stripID);
+    poly.SetPartID(partID);
+    return poly;
+}
+
+LB_PlacementRing::LB_PlacementRing(int capacity)
+{
+    int size = 2;
+    while(size < capacity)
+        size *= 2;
+
+    buffer.resize(size);
+    items = buffer.data();
+    mask = quint32(size - 1);
+}
+
+bool LB_PlacementRing::Push(const LB_Placement &item)
+{
+    quint32 h = head.loadRelaxed();
+    quint32 t = tail.loadAcquire();
+    if(h - t == quint32(buffer.size()))
+        return false;
+
+    items[h & mask] = item;
+    head.storeRelease(h + 1);
+    return true;
+}
+
+int LB_PlacementRing::Drain(QVector<LB_Placement> &out)
+{
+    // cleared first, an item pushed from now on asks for a new notification
+    notified.storeRelease(0);
+
+    quint32 t = tail.loadRelaxed();
+    quint32 h = head.loadAcquire();
+    int count = int(h - t);
+
+    out.reserve(out.size() + count);
+    for(quint32 i = t; i != h; ++i) {
+        out.append(items[i & mask]);
+    }
+    tail.storeRelease(h);
+    return count;
+}
@@ -0,0 +1,60 @@
+#ifndef LB_PLACEMENT_H
+#define LB_PLACEMENT_H
+
+#include <QVector>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+#include "LB_Polygon2D.h"
+using namespace Shape2D;
+
+// where one part ended up: the part given to the engine is rotated about the origin,
+// then translated and put on a strip
+struct LB_Placement
+{
+    int partID = -1;
+    int stripID = -1;
+    double rotation = 0; // degree
+    double dx = 0;
+    double dy = 0;
+
+    // the placed shape of part, part must be the polygon partID refers to
+    LB_Polygon2D Apply(const LB_Polygon2D &part) const;
+};
+
+// lock-free ring buffer between the thread running a nest (the only producer)
+// and one consumer, which takes the placements out in batches
+class LB_PlacementRing
+{
+public:
+    // the capacity is rounded up to a power of two
+    explicit LB_PlacementRing(int capacity = 4096);
+    Q_DISABLE_COPY(LB_PlacementRing)
+
+    // producer side, false if the ring is full
+    bool Push(const LB_Placement &item);
+    // true if the consumer has to be told about new items, at most once per Drain()
+    bool RequestNotify() {
+        return notified.testAndSetOrdered(0,1);
+    }
+
+    // consumer side, appends all waiting items to out and returns their number
+    int Drain(QVector<LB_Placement> &out);
+
+    int Capacity() const {
+        return buffer.size();
+    }
+
+private:
+    QVector<LB_Placement> buffer;
+    // taken once, so neither side ever touches the vector's sharing state
+    LB_Placement *items;
+    quint32 mask;
+
+    // free running counters, only the producer writes head and only the consumer writes tail
+    QAtomicInteger<quint32> head;
+    QAtomicInteger<quint32> tail;
+    QAtomicInt notified;
+};
+
+#endif // LB_PLACEMENT_H
@@ -1,5 +1,8 @@
 #include "LB_Polygon2D.h"
 
+#include <QHash>
+#include <algorithm>
+
 namespace Shape2D {
 
 LB_Polygon2D::LB_Polygon2D(std::initializer_list<LB_Coord2D> list) : QVector<LB_Coord2D>(list)
@@ -7,11 +10,7 @@ LB_Polygon2D::LB_Polygon2D(std::initializer_list<LB_Coord2D> list) : QVector<LB_
     if(list.size() == 0)
         return;
 
-    LB_Rect2D bounds = Bounds();
-    x = bounds.X();
-    y = bounds.Y();
-    width = bounds.Width();
-    height = bounds.Height();
+    ScanBounds();
 }
 
 QString LB_Polygon2D::ToString() const
@@ -26,44 +25,66 @@ QString LB_Polygon2D::ToString() const
 
 double LB_Polygon2D::Area() const
 {
+    if(cached & AREA)
+        return area;
+
     // https://zhuanlan.zhihu.com/p/110025234
-    double area = 0;
+    double sum = 0;
     int i, j;
     for (i=0, j=size()-1; i<size(); j=i++){
-        area += (at(j).X()+at(i).X()) * (at(j).Y()-at(i).Y());
+        sum += (at(j).X()+at(i).X()) * (at(j).Y()-at(i).Y());
     }
-    return 0.5*area;
+    area = 0.5*sum;
+    cached |= AREA;
+    return area;
 }
 
 void LB_Polygon2D::Rotate(double angle)
 {
     angle = angle * DEG2RAD;
+    const double c = cos(angle);
+    const double s = sin(angle);
+    LB_Coord2D *pnts = QVector<LB_Coord2D>::data();
     for(int i=0; i<size(); i++){
-        double x = operator[](i).X();
-        double y = operator[](i).Y();
-        operator[](i).RX() = x*cos(angle)-y*sin(angle);
-        operator[](i).RY() = x*sin(angle)+y*cos(angle);
+        double x = pnts[i].X();
+        double y = pnts[i].Y();
+        pnts[i].RX() = x*c-y*s;
+        pnts[i].RY() = x*s+y*c;
     }
     // reset bounding box
-    LB_Rect2D bounds = Bounds();
-    x = bounds.X();
-    y = bounds.Y();
-    width = bounds.Width();
-    height = bounds.Height();
+    cached = 0;
+    ScanBounds();
 }
 
 void LB_Polygon2D::Translate(double dx, double dy)
 {
+    LB_Coord2D *pnts = QVector<LB_Coord2D>::data();
     for(int i=0; i<size(); i++){
-        operator[](i).RX() += dx;
-        operator[](i).RY() += dy;
+        pnts[i].RX() += dx;
+        pnts[i].RY() += dy;
+    }
+
+    // the shape is the same, what depends on the location is shifted
+    if((cached & BOUNDS) && size() >= 3){
+        x += dx;
+        y += dy;
+        right += dx;
+        top += dy;
+        width = right - x;
+        height = top - y;
+    }
+    else{
+        ScanBounds();
+    }
+    if(cached & CENTROID){
+        centroid = centroid + LB_Coord2D(dx,dy);
+    }
+    if(cached & HULL){
+        for(int i=0; i<hull.size(); i++){
+            hull[i].RX() += dx;
+            hull[i].RY() += dy;
+        }
     }
-    // reset bounding box
-    LB_Rect2D bounds = Bounds();
-    x = bounds.X();
-    y = bounds.Y();
-    width = bounds.Width();
-    height = bounds.Height();
 }
 
 LB_Rect2D LB_Polygon2D::Bounds() const
@@ -72,6 +93,19 @@ LB_Rect2D LB_Polygon2D::Bounds() const
         return INVALID_RECT;
     }
 
+    UpdateBounds();
+    return LB_Rect2D(x,y,width,height);
+}
+
+void LB_Polygon2D::ScanBounds() const
+{
+    cached |= BOUNDS;
+    if(size() < 3){
+        x = y = width = height = DIM_MAX;
+        right = top = DIM_MAX;
+        return;
+    }
+
     double xmin = at(0).X();
     double xmax = at(0).X();
     double ymin = at(0).Y();
@@ -93,10 +127,12 @@ LB_Rect2D LB_Polygon2D::Bounds() const
         }
     }
 
-    return LB_Rect2D(xmin,
-                     ymin,
-                     xmax-xmin,
-                     ymax-ymin);
+    x = xmin;
+    y = ymin;
+    right = xmax;
+    top = ymax;
+    width = xmax-xmin;
+    height = ymax-ymin;
 }
 
 int LB_Polygon2D::RotateToMinBndRect()
@@ -157,6 +193,9 @@ void LB_Polygon2D::SetPosition(const LB_Coord2D &pnt, int index)
 
 bool LB_Polygon2D::IsConvex() const
 {
+    if(cached & CONVEX)
+        return convex;
+
     int size = this->size();
 
     bool frsign = LB_Coord2D::ZCrossProduct(at(0),at(1),at(2)) > 0;
@@ -168,6 +207,8 @@ bool LB_Polygon2D::IsConvex() const
         ret &= frsign == (zc > 0);
     }
 
+    convex = ret;
+    cached |= CONVEX;
     return ret;
 }
 
@@ -176,7 +217,114 @@ void LB_Polygon2D::SetAntiClockWise()
     if(IsAntiClockWise())
         return;
 
-    std::reverse(this->begin(),this->end());
+    Reverse();
+}
+
+void LB_Polygon2D::Reverse()
+{
+    // the reversed polygon only has the area of the other sign and another hash
+    const int keep = cached & ~HASH;
+    std::reverse(QVector<LB_Coord2D>::begin(),QVector<LB_Coord2D>::end());
+    area = -area;
+    cached = keep;
+}
+
+LB_Coord2D LB_Polygon2D::Centroid() const
+{
+    if(cached & CENTROID)
+        return centroid;
+
+    // relative to the first point, the products stay small
+    const int n = size();
+    double cross = 0, cx = 0, cy = 0;
+    double mx = 0, my = 0;
+    for(int i=0, j=n-1; i<n; j=i++){
+        double xi = at(i).X() - at(0).X();
+        double yi = at(i).Y() - at(0).Y();
+        double xj = at(j).X() - at(0).X();
+        double yj = at(j).Y() - at(0).Y();
+        double c = xj*yi - xi*yj;
+        cross += c;
+        cx += (xj+xi)*c;
+        cy += (yj+yi)*c;
+        mx += xi;
+        my += yi;
+    }
+
+    if(n == 0){
+        centroid = LB_Coord2D(0,0);
+    }
+    else if(cross != 0){
+        centroid = LB_Coord2D(at(0).X() + cx/(3*cross), at(0).Y() + cy/(3*cross));
+    }
+    else{
+        centroid = LB_Coord2D(at(0).X() + mx/n, at(0).Y() + my/n);
+    }
+    cached |= CENTROID;
+    return centroid;
+}
+
+QVector<LB_Coord2D> LB_Polygon2D::ConvexHull() const
+{
+    if(cached & HULL)
+        return hull;
+
+    // monotone chain, the closing point of a closed polygon is left out
+    int n = size();
+    if(n > 1 && at(0) == at(n-1))
+        n--;
+    QVector<LB_Coord2D> pnts(constBegin(),constBegin()+n);
+    std::sort(pnts.begin(),pnts.end(),[](const LB_Coord2D &p, const LB_Coord2D &q) {
+        return p.X() < q.X() || (p.X() == q.X() && p.Y() < q.Y());
+    });
+
+    if(pnts.size() < 3){
+        hull = pnts;
+    }
+    else{
+        hull.resize(2*pnts.size());
+        int k = 0;
+        for(int i=0;i<pnts.size();++i) {
+            while(k >= 2 && LB_Coord2D::ZCrossProduct(hull[k-2],hull[k-1],pnts[i]) <= 0)
+                k--;
+            hull[k++] = pnts[i];
+        }
+        for(int i=pnts.size()-2,lower=k+1;i>=0;--i) {
+            while(k >= lower && LB_Coord2D::ZCrossProduct(hull[k-2],hull[k-1],pnts[i]) <= 0)
+                k--;
+            hull[k++] = pnts[i];
+        }
+        hull.resize(k-1);
+    }
+    cached |= HULL;
+    return hull;
+}
+
+uint LB_Polygon2D::Hash() const
+{
+    if(cached & HASH)
+        return hash;
+
+    // the points relative to the first one, as the NFP cache keys them
+    uint h = uint(size());
+    for(int i=0;i<size();++i) {
+        const double rel[2] = {at(i).X()-at(0).X(), at(i).Y()-at(0).Y()};
+        h = qHashBits(rel,sizeof(rel),h);
+    }
+    hash = h;
+    cached |= HASH;
+    return hash;
+}
+
+void LB_Polygon2D::UpdateCache() const
+{
+    UpdateBounds();
+    Area();
+    if(size() >= 3)
+        IsConvex();
+    Centroid();
+    ConvexHull();
+    Hash();
 }
 
 QPolygonF LB_Polygon2D::ToPolygonF() const
@@ -234,106 +382,140 @@ PointInPolygon LB_Polygon2D::ContainPoint(const LB_Coord2D &point) const
 bool LB_Polygon2D::Intersect(const LB_Polygon2D &other) const
 {
     for(int i=0; i<size()-1; i++){
+        LB_Rect2D boxA = EdgeBounds(i);
         for(int j=0; j<other.size()-1; j++){
-            LB_Coord2D a1 = at(i);
-            LB_Coord2D a2 = at(i+1);
-            LB_Coord2D b1 = other.at(i);
-            LB_Coord2D b2 = other.at(i+1);
-
-            int prevbindex = (j == 0) ? other.size()-1 : j-1;
-            int prevaindex = (i == 0) ? size()-1 : i-1;
-            int nextbindex = (j+1 == other.size()-1) ? 0 : j+2;
-            int nextaindex = (i+1 == size()-1) ? 0 : i+2;
-
-            // go even further back if we happen to hit on a loop end LB_Coord2D
-            if(other[prevbindex] == other[j]){
-                prevbindex = (prevbindex == 0) ? other.size()-1 : prevbindex-1;
+            // edges whose boxes are apart can't touch
+            if(!LB_Polygon2D::BoundsMeet(boxA, other.EdgeBounds(j))){
+                continue;
             }
-
-            if(at(prevaindex) == at(i)){
-                prevaindex = (prevaindex == 0) ? size()-1 : prevaindex-1;
+            if(EdgesIntersect(other, i, j)){
+                return true;
             }
+        }
+    }
 
-            // go even further forward if we happen to hit on a loop end LB_Coord2D
-            if(other[nextbindex] == other[j+1]){
-                nextbindex = (nextbindex == other.size()-1) ? 0 : nextbindex+1;
-            }
+    return false;
+}
 
-            if(at(nextaindex) == at(i+1)){
-                nextaindex = (nextaindex == size()-1) ? 0 : nextaindex+1;
-            }
+LB_Rect2D LB_Polygon2D::EdgeBounds(int i) const
+{
+    const LB_Coord2D &p = at(i);
+    const LB_Coord2D &q = at(i+1 == size() ? 0 : i+1);
+    double left = std::min(p.X(), q.X());
+    double bottom = std::min(p.Y(), q.Y());
+    double wid = std::max(p.X(), q.X()) - left;
+    double hei = std::max(p.Y(), q.Y()) - bottom;
+    // OnSegment() reaches further off an edge shorter than 1e-3 than the margin of BoundsMeet()
+    if(wid < 1e-3 && hei < 1e-3) {
+        const double grow = LB_Coord2D::OnSegmentReach(p, q);
+        return LB_Rect2D(left - grow, bottom - grow, wid + 2*grow, hei + 2*grow);
+    }
+    return LB_Rect2D(left, bottom, wid, hei);
+}
 
-            LB_Coord2D a0 = at(prevaindex);
-            LB_Coord2D b0 = other[prevbindex];
+bool LB_Polygon2D::BoundsMeet(const LB_Rect2D &a, const LB_Rect2D &b)
+{
+    // grown a little, the touching tests are fuzzy
+    const double margin = 1e-6;
+    return a.X() <= b.X() + b.Width() + margin && b.X() <= a.X() + a.Width() + margin
+            && a.Y() <= b.Y() + b.Height() + margin && b.Y() <= a.Y() + a.Height() + margin;
+}
 
-            LB_Coord2D a3 = at(nextaindex);
-            LB_Coord2D b3 = other[nextbindex];
+bool LB_Polygon2D::EdgesIntersect(const LB_Polygon2D &other, int i, int j) const
+{
+    LB_Coord2D a1 = at(i);
+    LB_Coord2D a2 = at(i+1);
+    LB_Coord2D b1 = other.at(j);
+    LB_Coord2D b2 = other.at(j+1);
+
+    int prevbindex = (j == 0) ? other.size()-1 : j-1;
+    int prevaindex = (i == 0) ? size()-1 : i-1;
+    int nextbindex = (j+1 == other.size()-1) ? 0 : j+2;
+    int nextaindex = (i+1 == size()-1) ? 0 : i+2;
+
+    // go even further back if we happen to hit on a loop end LB_Coord2D
+    if(other[prevbindex] == other[j]){
+        prevbindex = (prevbindex == 0) ? other.size()-1 : prevbindex-1;
+    }
 
-            if(LB_Coord2D::OnSegment(a1,a2,b1) || (a1 == b1)){
-                // if a point is on a segment, it could intersect or it could not. Check via the neighboring points
-                PointInPolygon b0in = ContainPoint(b0);
-                PointInPolygon b2in = ContainPoint(b2);
-                //AMIR: TESTME is this comparison correct in terms of handling INVALID?
-                if((b0in == PointInPolygon::INSIDE && b2in == PointInPolygon::OUTSIDE)
-                        ||(b0in == PointInPolygon::OUTSIDE && b2in == PointInPolygon::INSIDE)){
-                    return true;
-                }
-                else{
-                    continue;
-                }
-            }
+    if(at(prevaindex) == at(i)){
+        prevaindex = (prevaindex == 0) ? size()-1 : prevaindex-1;
+    }
 
-            if(LB_Coord2D::OnSegment(a1,a2,b2) || (a2 == b2)){
-                // if a point is on a segment, it could intersect or it could not. Check via the neighboring points
-                PointInPolygon b1in = ContainPoint(b1);
-                PointInPolygon b3in = ContainPoint(b3);
-                //AMIR: TESTME is this comparison correct in terms of handling INVALID?
-                if((b1in == PointInPolygon::INSIDE && b3in == PointInPolygon::OUTSIDE)
-                        || (b1in == PointInPolygon::OUTSIDE && b3in == PointInPolygon::INSIDE)){
-                    return true;
-                }
-                else{
-                    continue;
-                }
-            }
+    // go even further forward if we happen to hit on a loop end LB_Coord2D
+    if(other[nextbindex] == other[j+1]){
+        nextbindex = (nextbindex == other.size()-1) ? 0 : nextbindex+1;
+    }
 
-            if(LB_Coord2D::OnSegment(b1,b2,a1) || (a1 == b2)){
-                // if a point is on a segment, it could intersect or it could not. Check via the neighboring points
-                PointInPolygon a0in = other.ContainPoint(a0);
-                PointInPolygon a2in = other.ContainPoint(a2);
-                //AMIR: TESTME is this comparison correct in terms of handling INVALID?
-                if((a0in == PointInPolygon::INSIDE && a2in == PointInPolygon::OUTSIDE)
-                        || (a0in == PointInPolygon::OUTSIDE && a2in == PointInPolygon::INSIDE)){
-                    return true;
-                }
-                else{
-                    continue;
-                }
-            }
+    if(at(nextaindex) == at(i+1)){
+        nextaindex = (nextaindex == size()-1) ? 0 : nextaindex+1;
+    }
 
-            if(LB_Coord2D::OnSegment(b1,b2,a2) || (a2 == b1)){
-                // if a point is on a segment, it could intersect or it could not. Check via the neighboring points
-                PointInPolygon a1in = other.ContainPoint(a1);
-                PointInPolygon a3in = other.ContainPoint(a3);
-                //AMIR: TESTME is this comparison correct in terms of handling INVALID?
-                if((a1in == PointInPolygon::INSIDE && a3in == PointInPolygon::OUTSIDE)
-                        || (a1in == PointInPolygon::OUTSIDE && a3in == PointInPolygon::INSIDE)){
-                    return true;
-                }
-                else{
-                    continue;
-                }
-            }
+    LB_Coord2D a0 = at(prevaindex);
+    LB_Coord2D b0 = other[prevbindex];
 
-            LB_Coord2D p = LB_Coord2D::LineIntersect(b1, b2, a1, a2);
+    LB_Coord2D a3 = at(nextaindex);
+    LB_Coord2D b3 = other[nextbindex];
 
-            if(p != INVALID_POINT){
-                return true;
-            }
+    if(LB_Coord2D::OnSegment(a1,a2,b1) || (a1 == b1)){
+        // if a point is on a segment, it could intersect or it could not. Check via the neighboring points
+        PointInPolygon b0in = ContainPoint(b0);
+        PointInPolygon b2in = ContainPoint(b2);
+        //AMIR: TESTME is this comparison correct in terms of handling INVALID?
+        if((b0in == PointInPolygon::INSIDE && b2in == PointInPolygon::OUTSIDE)
+                ||(b0in == PointInPolygon::OUTSIDE && b2in == PointInPolygon::INSIDE)){
+            return true;
+        }
+        else{
+            return false;
         }
     }
 
-    return false;
+    if(LB_Coord2D::OnSegment(a1,a2,b2) || (a2 == b2)){
+        // if a point is on a segment, it could intersect or it could not. Check via the neighboring points
+        PointInPolygon b1in = ContainPoint(b1);
+        PointInPolygon b3in = ContainPoint(b3);
+        //AMIR: TESTME is this comparison correct in terms of handling INVALID?
+        if((b1in == PointInPolygon::INSIDE && b3in == PointInPolygon::OUTSIDE)
+                || (b1in == PointInPolygon::OUTSIDE && b3in == PointInPolygon::INSIDE)){
+            return true;
+        }
+        else{
+            return false;
+        }
+    }
+
+    if(LB_Coord2D::OnSegment(b1,b2,a1) || (a1 == b2)){
+        // if a point is on a segment, it could intersect or it could not. Check via the neighboring points
+        PointInPolygon a0in = other.ContainPoint(a0);
+        PointInPolygon a2in = other.ContainPoint(a2);
+        //AMIR: TESTME is this comparison correct in terms of handling INVALID?
+        if((a0in == PointInPolygon::INSIDE && a2in == PointInPolygon::OUTSIDE)
+                || (a0in == PointInPolygon::OUTSIDE && a2in == PointInPolygon::INSIDE)){
+            return true;
+        }
+        else{
+            return false;
+        }
+    }
+
+    if(LB_Coord2D::OnSegment(b1,b2,a2) || (a2 == b1)){
+        // if a point is on a segment, it could intersect or it could not. Check via the neighboring points
+        PointInPolygon a1in = other.ContainPoint(a1);
+        PointInPolygon a3in = other.ContainPoint(a3);
+        //AMIR: TESTME is this comparison correct in terms of handling INVALID?
+        if((a1in == PointInPolygon::INSIDE && a3in == PointInPolygon::OUTSIDE)
+                || (a1in == PointInPolygon::OUTSIDE && a3in == PointInPolygon::INSIDE)){
+            return true;
+        }
+        else{
+            return false;
+        }
+    }
+
+    LB_Coord2D p = LB_Coord2D::LineIntersect(b1, b2, a1, a2);
+
+    return p != INVALID_POINT;
 }
 
 bool LB_Polygon2D::IsRectangle(double tolerance)
@@ -351,7 +533,9 @@ bool LB_Polygon2D::IsRectangle(double tolerance)
         }
     }
 
-    return true;
+    // a right triangle with its legs on the axes has its points on corners of its box too,
+    // only a rectangle covers the whole box
+    return fabs(fabs(Area()) - bb.Width()*bb.Height()) <= tolerance*(bb.Width() + bb.Height());
 }
 
 LB_Polygon2D LB_Polygon2D::United(const LB_Polygon2D &other) const
@@ -492,7 +676,7 @@ LB_Polygon2D LB_Polygon2D::United(const LB_Polygon2D &other) const
     for (i = 0; i < C.size(); i++) {
         int next = (i == C.size() - 1) ? 0 : i + 1;
         if (C[i] ==  C[next]) {
-            C.erase(C.begin() + i);
+            C.remove(i);
             i--;
         }
     }
@@ -510,10 +694,10 @@ LB_Polygon2D LB_Polygon2D::United(const LB_Polygon2D &other) const
                 bool signj = LB_Coord2D::ZCrossProduct(C[prej],C[j],C[nextj]) < 0;
 
                 if(C.IsAntiClockWise() == signi) {
-                    C[i] = C[i]*0.95 + C[prei]*0.05;
+                    C.SetPoint(i, C[i]*0.95 + C[prei]*0.05);
                 }
                 if(C.IsAntiClockWise() == signj) {
-                    C[j] = C[j]*0.95 + C[prej]*0.05;
+                    C.SetPoint(j, C[j]*0.95 + C[prej]*0.05);
                 }
             }
         }
@@ -549,6 +733,7 @@ LB_Polygon2D LB_Polygon2D::Shrinking(double offset) const
         result.append(p + (NV1+NV2)*(offset/sin_alpha));
     }
     result.SetID(stripID);
+    result.SetPartID(partID);
     return result;
 }
 
@@ -21,15 +21,19 @@ public:
     LB_Polygon2D(std::initializer_list<LB_Coord2D> list);
 
     double X() const {
+        UpdateBounds();
         return x;
     }
     double Y() const {
+        UpdateBounds();
         return y;
     }
     double Width() const {
+        UpdateBounds();
         return width;
     }
     double Height() const {
+        UpdateBounds();
         return height;
     }
     int ID() const {
@@ -38,6 +42,13 @@ public:
     void SetID(int val) {
         stripID = val;
     }
+    // index of the part in the job the polygon was made from
+    int PartID() const {
+        return partID;
+    }
+    void SetPartID(int val) {
+        partID = val;
+    }
     QString ToString() const;
 
     double Area() const;
@@ -57,6 +68,19 @@ public:
         return this->Area()<0;
     }
     void SetAntiClockWise();
+    // the points in the opposite order
+    void Reverse();
+
+    // area weighted, the mean of the vertices if the area is 0
+    LB_Coord2D Centroid() const;
+    // counterclockwise, without repeating the first point
+    QVector<LB_Coord2D> ConvexHull() const;
+    // of the shape, the same wherever the polygon is moved
+    uint Hash() const;
+    // the cached properties are filled on first use, by the const members too, so a polygon which
+    // several threads read at once, also through copies of a QVector sharing it, has them all
+    // computed with this first, by the thread which owns it
+    void UpdateCache() const;
 
     QPolygonF ToPolygonF() const;
     void FromPolygonF(const QPolygonF &aPoly);
@@ -73,12 +97,170 @@ public:
 
     LB_Polygon2D Shrinking(double offset) const;
 
-private:    
-    double x = 0;
-    double y = 0;
-    double width = 0;
-    double height = 0;
+    // the vertices are read only, also on a non-const polygon, so reading them keeps the cached
+    // properties; a vertex is written with replace() or SetPoint(), which drop them like every
+    // other member that edits the vertices
+    const LB_Coord2D &operator[](int i) const {
+        return QVector<LB_Coord2D>::operator[](i);
+    }
+    const LB_Coord2D *data() const {
+        return QVector<LB_Coord2D>::constData();
+    }
+    const_iterator begin() const {
+        return QVector<LB_Coord2D>::constBegin();
+    }
+    const_iterator end() const {
+        return QVector<LB_Coord2D>::constEnd();
+    }
+    const LB_Coord2D &first() const {
+        return QVector<LB_Coord2D>::constFirst();
+    }
+    const LB_Coord2D &last() const {
+        return QVector<LB_Coord2D>::constLast();
+    }
+    const LB_Coord2D &front() const {
+        return first();
+    }
+    const LB_Coord2D &back() const {
+        return last();
+    }
+    void SetPoint(int i, const LB_Coord2D &pnt) {
+        replace(i,pnt);
+    }
+    // the mark is no part of the shape, it keeps the cached properties
+    void SetMarked(int i, bool marked) {
+        QVector<LB_Coord2D>::operator[](i).setMarked(marked);
+    }
+    void append(const LB_Coord2D &pnt) {
+        Edited();
+        QVector<LB_Coord2D>::append(pnt);
+    }
+    void append(const QVector<LB_Coord2D> &pnts) {
+        Edited();
+        QVector<LB_Coord2D>::append(pnts);
+    }
+    void push_back(const LB_Coord2D &pnt) {
+        append(pnt);
+    }
+    void prepend(const LB_Coord2D &pnt) {
+        Edited();
+        QVector<LB_Coord2D>::prepend(pnt);
+    }
+    void push_front(const LB_Coord2D &pnt) {
+        prepend(pnt);
+    }
+    void insert(int i, const LB_Coord2D &pnt) {
+        Edited();
+        QVector<LB_Coord2D>::insert(i,pnt);
+    }
+    iterator insert(iterator before, const LB_Coord2D &pnt) {
+        Edited();
+        return QVector<LB_Coord2D>::insert(before,pnt);
+    }
+    void replace(int i, const LB_Coord2D &pnt) {
+        Edited();
+        QVector<LB_Coord2D>::replace(i,pnt);
+    }
+    void remove(int i) {
+        Edited();
+        QVector<LB_Coord2D>::remove(i);
+    }
+    void remove(int i, int count) {
+        Edited();
+        QVector<LB_Coord2D>::remove(i,count);
+    }
+    void removeAt(int i) {
+        remove(i);
+    }
+    void removeFirst() {
+        remove(0);
+    }
+    void removeLast() {
+        remove(size()-1);
+    }
+    void pop_back() {
+        removeLast();
+    }
+    iterator erase(iterator pos) {
+        Edited();
+        return QVector<LB_Coord2D>::erase(pos);
+    }
+    iterator erase(iterator first, iterator last) {
+        Edited();
+        return QVector<LB_Coord2D>::erase(first,last);
+    }
+    LB_Coord2D takeAt(int i) {
+        Edited();
+        return QVector<LB_Coord2D>::takeAt(i);
+    }
+    LB_Coord2D takeFirst() {
+        return takeAt(0);
+    }
+    LB_Coord2D takeLast() {
+        return takeAt(size()-1);
+    }
+    void resize(int count) {
+        Edited();
+        QVector<LB_Coord2D>::resize(count);
+    }
+    void clear() {
+        Edited();
+        QVector<LB_Coord2D>::clear();
+    }
+    LB_Polygon2D &operator<<(const LB_Coord2D &pnt) {
+        append(pnt);
+        return *this;
+    }
+    LB_Polygon2D &operator+=(const LB_Coord2D &pnt) {
+        append(pnt);
+        return *this;
+    }
+
+private:
+    friend class LB_PreparedPolygon;
+
+    // the box of the edge from point i to the next one, grown by what OnSegment() accepts
+    LB_Rect2D EdgeBounds(int i) const;
+    static bool BoundsMeet(const LB_Rect2D &a, const LB_Rect2D &b);
+    // edge i of this against edge j of other, the test Intersect() runs on every pair
+    bool EdgesIntersect(const LB_Polygon2D &other, int i, int j) const;
+
+    // the properties which are cached until the vertices are edited
+    // bounds, area, convexity and the hash stay valid under translation, the others are shifted
+    enum CacheFlag {
+        BOUNDS = 0x1,
+        AREA = 0x2,
+        CONVEX = 0x4,
+        CENTROID = 0x8,
+        HULL = 0x10,
+        HASH = 0x20
+    };
+    void Edited() {
+        cached = 0;
+    }
+    void UpdateBounds() const {
+        if(!(cached & BOUNDS))
+            ScanBounds();
+    }
+    // the full pass over the vertices
+    void ScanBounds() const;
+
+    // an empty polygon is at 0,0 until it gets points
+    mutable int cached = BOUNDS;
+    mutable double x = 0;
+    mutable double y = 0;
+    mutable double width = 0;
+    mutable double height = 0;
+    // kept to shift the bounds exactly, width is right - x
+    mutable double right = 0;
+    mutable double top = 0;
+    mutable double area = 0;
+    mutable bool convex = false;
+    mutable LB_Coord2D centroid;
+    mutable QVector<LB_Coord2D> hull;
+    mutable uint hash = 0;
     int stripID = -1;
+    int partID = -1;
 };
 
 }
@@ -0,0 +1,133 @@
+#include "LB_PreparedPolygon.h"
+
+#include <algorithm>
+
+namespace Shape2D {
+
+LB_PreparedPolygon::LB_PreparedPolygon(const LB_Polygon2D &aPoly) :
+    poly(aPoly)
+{
+    const int n = poly.size();
+    if(n < 3)
+        return;
+
+    double maxY = -DIM_MAX;
+    double extent = 0;
+    bottom = DIM_MAX;
+    foreach(const LB_Coord2D &p,poly) {
+        bottom = std::min(bottom,p.Y());
+        maxY = std::max(maxY,p.Y());
+        extent = std::max(extent,std::max(fabs(p.X()),fabs(p.Y())));
+    }
+    // the boundary tests are fuzzy, every edge is also filed in the bands just beyond its ends,
+    // a short edge as far as OnSegment() reaches off it
+    const double base = 1e-6 + extent*1e-10;
+    margin = base;
+    edges.resize(n);
+    for(int k=0;k<n;++k) {
+        Edge &e = edges[k];
+        e.start = k;
+        e.end = (k+1 == n) ? 0 : k+1;
+        const LB_Coord2D &s = poly[e.start];
+        const LB_Coord2D &t = poly[e.end];
+        const double grow = std::max(base,LB_Coord2D::OnSegmentReach(s,t));
+        margin = std::max(margin,grow);
+        e.x0 = std::min(s.X(),t.X()) - grow;
+        e.y0 = std::min(s.Y(),t.Y()) - grow;
+        e.x1 = std::max(s.X(),t.X()) + grow;
+        e.y1 = std::max(s.Y(),t.Y()) + grow;
+        // as ContainPoint computes them, from the end point
+        e.dx = s.X() - t.X();
+        e.dy = s.Y() - t.Y();
+        e.empty = s == t;
+    }
+    bottom -= margin;
+    bands = qBound(1,n,1024);
+    bandHei = (maxY + margin - bottom)/bands;
+
+    // counting sort of the edges into the bands
+    bandStart.fill(0,bands+1);
+    foreach(const Edge &e,edges) {
+        for(int b=Band(e.y0);b<=Band(e.y1);++b) {
+            bandStart[b+1]++;
+        }
+    }
+    for(int b=0;b<bands;++b) {
+        bandStart[b+1] += bandStart[b];
+    }
+    bandEdges.resize(bandStart[bands]);
+    QVector<int> fill(bandStart);
+    for(int k=0;k<n;++k) {
+        for(int b=Band(edges[k].y0);b<=Band(edges[k].y1);++b) {
+            bandEdges[fill[b]++] = k;
+        }
+    }
+}
+
+PointInPolygon LB_PreparedPolygon::Locate(const LB_Coord2D &point, int band) const
+{
+    const double px = point.X();
+    const double py = point.Y();
+
+    bool inside = false;
+    for(int k=bandStart[band];k<bandStart[band+1];++k) {
+        const Edge &e = edges[bandEdges[k]];
+        const LB_Coord2D &pi = poly[e.end];
+
+        // only a point in the box of an edge can lie on it
+        if(px >= e.x0 && px <= e.x1 && py >= e.y0 && py <= e.y1) {
+            if(pi == point)
+                return PointInPolygon::INVALID;
+            if(LB_Coord2D::OnSegment(pi,poly[e.start],point))
+                return PointInPolygon::INVALID;
+        }
+        if(e.empty)
+            continue;
+
+        const double yi = pi.Y();
+        if(((yi > py) != (poly[e.start].Y() > py)) && (px < e.dx * (py - yi) / e.dy + pi.X()))
+            inside = !inside;
+    }
+    return inside ? PointInPolygon::INSIDE : PointInPolygon::OUTSIDE;
+}
+
+PointInPolygon LB_PreparedPolygon::ContainPoint(const LB_Coord2D &point) const
+{
+    if(poly.size() < 3)
+        return PointInPolygon::INVALID;
+    if(!InBounds(point.Y()))
+        return PointInPolygon::OUTSIDE;
+    return Locate(point,Band(point.Y()));
+}
+
+bool LB_PreparedPolygon::Intersect(const LB_Polygon2D &other) const
+{
+    const int n = poly.size();
+    if(n < 3)
+        return poly.Intersect(other);
+
+    // the same pairs as LB_Polygon2D::Intersect, found through the bands
+    for(int j=0;j<other.size()-1;++j) {
+        LB_Rect2D boxB = other.EdgeBounds(j);
+        if(boxB.Y() - margin > bottom + bands*bandHei || boxB.Y() + boxB.Height() + margin < bottom)
+            continue;
+
+        const int b0 = Band(boxB.Y() - margin);
+        const int b1 = Band(boxB.Y() + boxB.Height() + margin);
+        for(int b=b0;b<=b1;++b) {
+            for(int k=bandStart[b];k<bandStart[b+1];++k) {
+                const int i = bandEdges[k];
+                // the closing edge isn't tested by Intersect, an edge in several bands is tested once
+                if(i == n-1 || b != std::max(b0,Band(edges[i].y0)))
+                    continue;
+                if(!LB_Polygon2D::BoundsMeet(poly.EdgeBounds(i),boxB))
+                    continue;
+                if(poly.EdgesIntersect(other,i,j))
+                    return true;
+            }
+        }
+    }
+    return false;
+}
+
+}
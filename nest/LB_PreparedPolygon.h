@@ -0,0 +1,60 @@
+#ifndef LB_PREPAREDPOLYGON_H
+#define LB_PREPAREDPOLYGON_H
+
+#include <QVector>
+
+#include "LB_Polygon2D.h"
+
+namespace Shape2D {
+
+// a polygon which is queried many times while it doesn't move
+// its edges are filed in horizontal bands with their deltas and boxes cached, so a point is only
+// tested against the few edges of its band
+// answers exactly like the LB_Polygon2D methods of the same name
+class LB_PreparedPolygon
+{
+public:
+    LB_PreparedPolygon() {}
+    explicit LB_PreparedPolygon(const LB_Polygon2D &aPoly);
+
+    const LB_Polygon2D &Polygon() const {
+        return poly;
+    }
+
+    PointInPolygon ContainPoint(const LB_Coord2D &point) const;
+
+    // only the pairs of edges whose boxes meet get the exact test
+    bool Intersect(const LB_Polygon2D &other) const;
+
+private:
+    // the edge from point start to point end, the boxes are grown by margin
+    struct Edge {
+        int start;
+        int end;
+        double x0, y0, x1, y1;
+        double dx, dy;
+        bool empty;
+    };
+
+    int Band(double y) const {
+        return bandHei > 0 ? qBound(0, int((y - bottom) / bandHei), bands - 1) : 0;
+    }
+    bool InBounds(double py) const {
+        return py >= bottom && py <= bottom + bands*bandHei;
+    }
+    PointInPolygon Locate(const LB_Coord2D &point, int band) const;
+
+    LB_Polygon2D poly;
+    double margin = 0;
+    double bottom = 0;
+    double bandHei = 0;
+    int bands = 1;
+    QVector<Edge> edges;
+    // the edges of band b are bandEdges[bandStart[b]] .. bandEdges[bandStart[b+1]-1]
+    QVector<int> bandStart;
+    QVector<int> bandEdges;
+};
+
+}
+
+#endif // LB_PREPAREDPOLYGON_H
@@ -0,0 +1,336 @@
+#include "LB_RasterExport.h"
+#include "LB_NestIO.h"
+
+#include <QFile>
+#include <QPainter>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+
+// tiff tags
+enum {
+    TAG_IMAGE_WIDTH = 256,
+    TAG_IMAGE_LENGTH = 257,
+    TAG_BITS_PER_SAMPLE = 258,
+    TAG_COMPRESSION = 259,
+    TAG_PHOTOMETRIC = 262,
+    TAG_SAMPLES_PER_PIXEL = 277,
+    TAG_PLANAR_CONFIG = 284,
+    TAG_TILE_WIDTH = 322,
+    TAG_TILE_LENGTH = 323,
+    TAG_TILE_OFFSETS = 324,
+    TAG_TILE_BYTE_COUNTS = 325
+};
+
+enum {
+    TYPE_SHORT = 3,
+    TYPE_LONG = 4
+};
+
+static void WriteU16(QByteArray &out, quint16 v)
+{
+    out.append(char(v & 0xff));
+    out.append(char(v >> 8));
+}
+
+static void WriteU32(QByteArray &out, quint32 v)
+{
+    WriteU16(out,quint16(v & 0xffff));
+    WriteU16(out,quint16(v >> 16));
+}
+
+static void WriteEntry(QByteArray &out, quint16 tag, quint16 type, quint32 count, quint32 value)
+{
+    WriteU16(out,tag);
+    WriteU16(out,type);
+    WriteU32(out,count);
+    // a single short is left-justified in the value field
+    if(type == TYPE_SHORT && count == 1) {
+        WriteU16(out,quint16(value));
+        WriteU16(out,0);
+    }
+    else {
+        WriteU32(out,value);
+    }
+}
+
+// same color for a part in every export
+static QColor PartColor(int partID)
+{
+    return QColor::fromHsv((qMax(0,partID)*137) % 360,150,230);
+}
+
+LB_RasterExport::LB_RasterExport(const LB_NestConfig &aConfig) :
+    config(aConfig)
+{
+}
+
+void LB_RasterExport::SetLayout(const QVector<LB_Polygon2D> &parts, const QVector<LB_Placement> &placements)
+{
+    shapes.resize(placements.size());
+    partIDs.resize(placements.size());
+    stripNb = 0;
+
+    QVector<int> index(placements.size());
+    for(int i=0;i<index.size();++i) {
+        index[i] = i;
+        stripNb = qMax(stripNb,placements[i].stripID+1);
+    }
+
+    // every shape is written to its own slot
+    const double stripWid = config.StripWidth();
+    QtConcurrent::blockingMap(index,[&](int i) {
+        const LB_Placement &aPlacement = placements[i];
+        LB_Polygon2D poly = aPlacement.Apply(parts[aPlacement.partID]);
+        poly.Translate(aPlacement.stripID*stripWid,0);
+        shapes[i] = poly.ToPolygonF();
+        partIDs[i] = aPlacement.partID;
+    });
+
+    BinShapes();
+}
+
+void LB_RasterExport::SetLayout(const QVector<LB_Polygon2D> &placed)
+{
+    shapes.resize(placed.size());
+    partIDs.resize(placed.size());
+    stripNb = 0;
+
+    const double stripWid = config.StripWidth();
+    for(int i=0;i<placed.size();++i) {
+        LB_Polygon2D poly = placed[i];
+        poly.Translate(poly.ID()*stripWid,0);
+        shapes[i] = poly.ToPolygonF();
+        partIDs[i] = poly.PartID() < 0 ? i : poly.PartID();
+        stripNb = qMax(stripNb,placed[i].ID()+1);
+    }
+
+    BinShapes();
+}
+
+void LB_RasterExport::BinShapes()
+{
+    const double tileUnits = tileSize/scale;
+    tilesX = qMax(1,int(std::ceil(stripNb*config.StripWidth()/tileUnits)));
+    tilesY = qMax(1,int(std::ceil(config.StripHeight()/tileUnits)));
+
+    bins.clear();
+    bins.resize(tilesX*tilesY);
+    for(int i=0;i<shapes.size();++i) {
+        const QRectF box = shapes[i].boundingRect();
+        int x0 = qBound(0,int(box.left()/tileUnits),tilesX-1);
+        int x1 = qBound(0,int(box.right()/tileUnits),tilesX-1);
+        int y0 = qBound(0,int(box.top()/tileUnits),tilesY-1);
+        int y1 = qBound(0,int(box.bottom()/tileUnits),tilesY-1);
+        for(int y=y0;y<=y1;++y) {
+            for(int x=x0;x<=x1;++x) {
+                bins[y*tilesX+x].append(i);
+            }
+        }
+    }
+}
+
+QImage LB_RasterExport::RenderRect(const QRect &pixelRect) const
+{
+    QImage result(pixelRect.size(),QImage::Format_RGB32);
+    result.fill(Qt::white);
+
+    QPainter aPainter(&result);
+    aPainter.setRenderHints(aPainter.renderHints() | QPainter::Antialiasing);
+    aPainter.translate(-pixelRect.topLeft());
+    aPainter.scale(scale,scale);
+
+    // layout area of the rect, slightly larger for the antialiasing
+    const QRectF area(pixelRect.left()/scale-1,pixelRect.top()/scale-1,
+                      pixelRect.width()/scale+2,pixelRect.height()/scale+2);
+    const double tileUnits = tileSize/scale;
+    int x0 = qBound(0,int(area.left()/tileUnits),tilesX-1);
+    int x1 = qBound(0,int(area.right()/tileUnits),tilesX-1);
+    int y0 = qBound(0,int(area.top()/tileUnits),tilesY-1);
+    int y1 = qBound(0,int(area.bottom()/tileUnits),tilesY-1);
+
+    // a shape may sit in several bins, draw it once
+    QVector<int> visible;
+    for(int y=y0;y<=y1;++y) {
+        for(int x=x0;x<=x1;++x) {
+            visible += bins[y*tilesX+x];
+        }
+    }
+    std::sort(visible.begin(),visible.end());
+    visible.erase(std::unique(visible.begin(),visible.end()),visible.end());
+
+    aPainter.setPen(Qt::NoPen);
+    foreach(int i,visible) {
+        if(!shapes[i].boundingRect().intersects(area))
+            continue;
+        aPainter.setBrush(PartColor(partIDs[i]));
+        aPainter.drawPolygon(shapes[i]);
+    }
+
+    // strip borders
+    QPen border(Qt::red);
+    border.setCosmetic(true);
+    aPainter.setPen(border);
+    aPainter.setBrush(Qt::NoBrush);
+    const double stripWid = config.StripWidth();
+    int s0 = qMax(0,int(area.left()/stripWid));
+    int s1 = qMin(stripNb-1,int(area.right()/stripWid));
+    for(int s=s0;s<=s1;++s) {
+        aPainter.drawRect(QRectF(s*stripWid,0,stripWid,config.StripHeight()));
+    }
+
+    return result;
+}
+
+bool LB_RasterExport::ExportTiff(const QString &fileName)
+{
+    const qint64 width = qint64(std::ceil(stripNb*config.StripWidth()*scale));
+    const qint64 height = qint64(std::ceil(config.StripHeight()*scale));
+    if(stripNb == 0 || width <= 0 || height <= 0) {
+        errorString = "nothing to export";
+        return false;
+    }
+    // the tiles are cut on the pixel grid, not on the bins
+    const int across = int((width+tileSize-1)/tileSize);
+    const int down = int((height+tileSize-1)/tileSize);
+    const int tileCount = across*down;
+
+    QFile out(fileName);
+    if(!out.open(QIODevice::WriteOnly)) {
+        errorString = QString("cannot write %1").arg(fileName);
+        return false;
+    }
+
+    // little-endian header, the IFD offset is written at the end
+    QByteArray header("II");
+    WriteU16(header,42);
+    WriteU32(header,0);
+    out.write(header);
+
+    QVector<quint32> offsets(tileCount), byteCounts(tileCount);
+
+    // render and compress a batch of tiles in parallel, then write it in order,
+    // only one batch of tiles is in memory at a time
+    const int batchSize = qMax(1,QThread::idealThreadCount()*2);
+    QVector<int> batch;
+    QVector<QByteArray> encoded;
+    for(int first=0;first<tileCount;first+=batchSize) {
+        const int count = qMin(batchSize,tileCount-first);
+        batch.resize(count);
+        encoded.resize(count);
+        for(int i=0;i<count;++i) {
+            batch[i] = i;
+        }
+
+        QtConcurrent::blockingMap(batch,[&](int i) {
+            const int tile = first+i;
+            QImage img = RenderRect(QRect((tile%across)*tileSize,(tile/across)*tileSize,
+                                          tileSize,tileSize)).convertToFormat(QImage::Format_RGB888);
+
+            QByteArray raw;
+            raw.reserve(tileSize*tileSize*3);
+            for(int y=0;y<tileSize;++y) {
+                raw.append(reinterpret_cast<const char*>(img.constScanLine(y)),tileSize*3);
+            }
+            // deflate: the zlib stream without the length qCompress puts in front
+            encoded[i] = qCompress(raw).mid(4);
+        });
+
+        for(int i=0;i<count;++i) {
+            if(out.pos()+encoded[i].size() > 0xffffffffLL) {
+                errorString = "the image is larger than 4GB, lower the scale";
+                return false;
+            }
+            offsets[first+i] = quint32(out.pos());
+            byteCounts[first+i] = quint32(encoded[i].size());
+            if(out.write(encoded[i]) != encoded[i].size()) {
+                errorString = out.errorString();
+                return false;
+            }
+        }
+    }
+
+    // the arrays the IFD points to, then the IFD itself
+    QByteArray tail;
+    const quint32 bitsOffset = quint32(out.pos());
+    for(int i=0;i<3;++i) {
+        WriteU16(tail,8);
+    }
+    const quint32 offsetsOffset = bitsOffset+quint32(tail.size());
+    foreach(quint32 v,offsets) {
+        WriteU32(tail,v);
+    }
+    const quint32 countsOffset = bitsOffset+quint32(tail.size());
+    foreach(quint32 v,byteCounts) {
+        WriteU32(tail,v);
+    }
+    if(tail.size()%2)
+        tail.append('\0');
+    const quint32 ifdOffset = bitsOffset+quint32(tail.size());
+
+    // entries sorted by tag, arrays of one value are stored inline
+    WriteU16(tail,11);
+    WriteEntry(tail,TAG_IMAGE_WIDTH,TYPE_LONG,1,quint32(width));
+    WriteEntry(tail,TAG_IMAGE_LENGTH,TYPE_LONG,1,quint32(height));
+    WriteEntry(tail,TAG_BITS_PER_SAMPLE,TYPE_SHORT,3,bitsOffset);
+    WriteEntry(tail,TAG_COMPRESSION,TYPE_SHORT,1,8);
+    WriteEntry(tail,TAG_PHOTOMETRIC,TYPE_SHORT,1,2);
+    WriteEntry(tail,TAG_SAMPLES_PER_PIXEL,TYPE_SHORT,1,3);
+    WriteEntry(tail,TAG_PLANAR_CONFIG,TYPE_SHORT,1,1);
+    WriteEntry(tail,TAG_TILE_WIDTH,TYPE_LONG,1,quint32(tileSize));
+    WriteEntry(tail,TAG_TILE_LENGTH,TYPE_LONG,1,quint32(tileSize));
+    WriteEntry(tail,TAG_TILE_OFFSETS,TYPE_LONG,quint32(tileCount),tileCount == 1 ? offsets[0] : offsetsOffset);
+    WriteEntry(tail,TAG_TILE_BYTE_COUNTS,TYPE_LONG,quint32(tileCount),tileCount == 1 ? byteCounts[0] : countsOffset);
+    WriteU32(tail,0);
+
+    if(out.pos()+tail.size() > 0xffffffffLL) {
+        errorString = "the image is larger than 4GB, lower the scale";
+        return false;
+    }
+    out.write(tail);
+
+    QByteArray first;
+    WriteU32(first,ifdOffset);
+    out.seek(4);
+    out.write(first);
+
+    if(out.error() != QFile::NoError) {
+        errorString = out.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool LB_RasterExport::ExportStrips(const QString &fileName)
+{
+    if(stripNb == 0) {
+        errorString = "nothing to export";
+        return false;
+    }
+
+    const int stripPixWid = int(std::ceil(config.StripWidth()*scale));
+    const int stripPixHei = int(std::ceil(config.StripHeight()*scale));
+
+    // one strip per task, a strip image is the most that is held per thread
+    QVector<int> index(stripNb);
+    QVector<QString> failed(stripNb);
+    for(int i=0;i<stripNb;++i) {
+        index[i] = i;
+    }
+    QtConcurrent::blockingMap(index,[&](int s) {
+        const int left = int(std::floor(s*config.StripWidth()*scale));
+        QImage img = RenderRect(QRect(left,0,stripPixWid,stripPixHei));
+        QString stripName = NestIO::StripFileName(fileName,s);
+        if(!img.save(stripName))
+            failed[s] = stripName;
+    });
+
+    foreach(const QString &aName,failed) {
+        if(!aName.isEmpty()) {
+            errorString = QString("cannot write %1").arg(aName);
+            return false;
+        }
+    }
+    return true;
+}
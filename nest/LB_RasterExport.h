@@ -0,0 +1,65 @@
+#ifndef LB_RASTEREXPORT_H
+#define LB_RASTEREXPORT_H
+
+#include <QVector>
+#include <QPolygonF>
+#include <QImage>
+
+#include "LB_Polygon2D.h"
+#include "LB_NestConfig.h"
+#include "LB_Placement.h"
+using namespace Shape2D;
+using namespace NestConfig;
+
+// renders a nest result to image files without a scene and without ever
+// holding the image of the whole layout, so it also runs headless
+// the strips are laid side by side like in the viewer
+class LB_RasterExport
+{
+public:
+    explicit LB_RasterExport(const LB_NestConfig &aConfig);
+
+    // the layout, either as placement records on the parts given to the engine
+    // or as placed shapes whose ID() is the strip
+    void SetLayout(const QVector<LB_Polygon2D> &parts, const QVector<LB_Placement> &placements);
+    void SetLayout(const QVector<LB_Polygon2D> &placed);
+
+    // pixels per unit of length
+    void SetScale(double pixelsPerUnit) {
+        scale = pixelsPerUnit;
+    }
+    // tile side in pixels, a multiple of 16
+    void SetTileSize(int size) {
+        tileSize = qMax(16,(size+15)/16*16);
+    }
+
+    // one tiled TIFF of the whole layout, the tiles are rendered in parallel
+    // and written as soon as they are done
+    bool ExportTiff(const QString &fileName);
+    // one image per strip, named after fileName with the strip index before the suffix
+    bool ExportStrips(const QString &fileName);
+
+    QString ErrorString() const {
+        return errorString;
+    }
+
+private:
+    void BinShapes();
+    QImage RenderRect(const QRect &pixelRect) const;
+
+    LB_NestConfig config;
+    double scale = 1;
+    int tileSize = 512;
+
+    int stripNb = 0;
+    QVector<QPolygonF> shapes; // in layout coordinates
+    QVector<int> partIDs;      // for the colors
+
+    // the shapes overlapping each tile of the layout
+    int tilesX = 0, tilesY = 0;
+    QVector<QVector<int>> bins;
+
+    QString errorString;
+};
+
+#endif // LB_RASTEREXPORT_H
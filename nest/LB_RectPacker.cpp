@@ -0,0 +1,365 @@
+#include "LB_RectPacker.h"
+
+#include <QHash>
+#include <QScopedPointer>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double PACK_TOL = 1e-9;
+
+struct FreeRect
+{
+    double x, y, width, height;
+
+    bool Contains(const FreeRect &other) const {
+        return other.x >= x - PACK_TOL && other.y >= y - PACK_TOL
+                && other.x + other.width <= x + width + PACK_TOL
+                && other.y + other.height <= y + height + PACK_TOL;
+    }
+};
+
+// one bin of each method, Insert() finds a place for w*h or returns false
+class Bin
+{
+public:
+    virtual ~Bin() {}
+    virtual bool Insert(double w, double h, bool allowRotation, LB_PackedRect &result) = 0;
+};
+
+class MaxRectsBin : public Bin
+{
+public:
+    MaxRectsBin(double binWid, double binHei) {
+        freeRects.append({0,0,binWid,binHei});
+    }
+
+    bool Insert(double w, double h, bool allowRotation, LB_PackedRect &result) override {
+        double bestShort = std::numeric_limits<double>::max();
+        double bestLong = std::numeric_limits<double>::max();
+        FreeRect best = {0,0,0,0};
+        bool found = false;
+
+        for(const FreeRect &aFree : freeRects) {
+            for(int turn=0;turn<(allowRotation ? 2 : 1);++turn) {
+                double rw = turn ? h : w;
+                double rh = turn ? w : h;
+                if(rw > aFree.width + PACK_TOL || rh > aFree.height + PACK_TOL)
+                    continue;
+
+                double leftW = aFree.width - rw;
+                double leftH = aFree.height - rh;
+                double shortSide = std::min(leftW,leftH);
+                double longSide = std::max(leftW,leftH);
+                if(shortSide < bestShort || (shortSide == bestShort && longSide < bestLong)) {
+                    bestShort = shortSide;
+                    bestLong = longSide;
+                    best = {aFree.x,aFree.y,rw,rh};
+                    result.rotated = turn;
+                    found = true;
+                }
+            }
+        }
+        if(!found)
+            return false;
+
+        result.x = best.x;
+        result.y = best.y;
+        Place(best);
+        return true;
+    }
+
+private:
+    void Place(const FreeRect &used) {
+        // split every free rectangle the new one overlaps into the maximal rectangles around it
+        QVector<FreeRect> next;
+        next.reserve(freeRects.size()+4);
+        for(const FreeRect &f : freeRects) {
+            if(used.x >= f.x + f.width - PACK_TOL || used.x + used.width <= f.x + PACK_TOL
+                    || used.y >= f.y + f.height - PACK_TOL || used.y + used.height <= f.y + PACK_TOL) {
+                next.append(f);
+                continue;
+            }
+            if(used.x > f.x + PACK_TOL)
+                next.append({f.x,f.y,used.x-f.x,f.height});
+            if(used.x + used.width < f.x + f.width - PACK_TOL)
+                next.append({used.x+used.width,f.y,f.x+f.width-used.x-used.width,f.height});
+            if(used.y > f.y + PACK_TOL)
+                next.append({f.x,f.y,f.width,used.y-f.y});
+            if(used.y + used.height < f.y + f.height - PACK_TOL)
+                next.append({f.x,used.y+used.height,f.width,f.y+f.height-used.y-used.height});
+        }
+
+        // drop the rectangles contained in another one
+        freeRects.clear();
+        for(int i=0;i<next.size();++i) {
+            bool contained = false;
+            for(int j=0;j<next.size() && !contained;++j) {
+                if(i == j || !next[j].Contains(next[i]))
+                    continue;
+                // of two equal rectangles keep the first
+                contained = !next[i].Contains(next[j]) || j < i;
+            }
+            if(!contained)
+                freeRects.append(next[i]);
+        }
+    }
+
+    QVector<FreeRect> freeRects;
+};
+
+class SkylineBin : public Bin
+{
+public:
+    SkylineBin(double binWid, double binHei) : binWid(binWid), binHei(binHei) {
+        skyline.append({0,0,binWid});
+    }
+
+    bool Insert(double w, double h, bool allowRotation, LB_PackedRect &result) override {
+        double bestY = std::numeric_limits<double>::max();
+        double bestX = std::numeric_limits<double>::max();
+        int bestIndex = -1;
+        double bestW = 0, bestH = 0;
+
+        for(int i=0;i<skyline.size();++i) {
+            for(int turn=0;turn<(allowRotation ? 2 : 1);++turn) {
+                double rw = turn ? h : w;
+                double rh = turn ? w : h;
+                double y = 0;
+                if(!Fit(i,rw,rh,y))
+                    continue;
+                if(y < bestY || (y == bestY && skyline[i].x < bestX)) {
+                    bestY = y;
+                    bestX = skyline[i].x;
+                    bestIndex = i;
+                    bestW = rw;
+                    bestH = rh;
+                    result.rotated = turn;
+                }
+            }
+        }
+        if(bestIndex == -1)
+            return false;
+
+        result.x = bestX;
+        result.y = bestY;
+        AddLevel(bestIndex,bestX,bestY+bestH,bestW);
+        return true;
+    }
+
+private:
+    // a segment of the skyline: [x,x+width) at height y
+    struct Node {
+        double x, y, width;
+    };
+
+    // lowest y the rectangle can sit at when its left side is on node index
+    bool Fit(int index, double w, double h, double &y) const {
+        double x = skyline[index].x;
+        if(x + w > binWid + PACK_TOL)
+            return false;
+
+        double widthLeft = w;
+        y = skyline[index].y;
+        for(int i=index;widthLeft > PACK_TOL;++i) {
+            if(i >= skyline.size())
+                return false;
+            y = std::max(y,skyline[i].y);
+            if(y + h > binHei + PACK_TOL)
+                return false;
+            widthLeft -= skyline[i].width;
+        }
+        return true;
+    }
+
+    void AddLevel(int index, double x, double y, double w) {
+        skyline.insert(index,{x,y,w});
+
+        // cut the nodes now under the new one
+        for(int i=index+1;i<skyline.size();) {
+            const double right = skyline[i-1].x + skyline[i-1].width;
+            if(skyline[i].x >= right - PACK_TOL)
+                break;
+            const double shrink = right - skyline[i].x;
+            skyline[i].x += shrink;
+            skyline[i].width -= shrink;
+            if(skyline[i].width <= PACK_TOL) {
+                skyline.remove(i);
+                continue;
+            }
+            break;
+        }
+
+        // merge neighbours of the same height
+        for(int i=0;i+1<skyline.size();) {
+            if(std::abs(skyline[i].y - skyline[i+1].y) <= PACK_TOL) {
+                skyline[i].width += skyline[i+1].width;
+                skyline.remove(i+1);
+            }
+            else {
+                ++i;
+            }
+        }
+    }
+
+    double binWid, binHei;
+    QVector<Node> skyline;
+};
+
+class GuillotineBin : public Bin
+{
+public:
+    GuillotineBin(double binWid, double binHei) {
+        freeRects.append({0,0,binWid,binHei});
+    }
+
+    bool Insert(double w, double h, bool allowRotation, LB_PackedRect &result) override {
+        double bestArea = std::numeric_limits<double>::max();
+        int bestIndex = -1;
+        double bestW = 0, bestH = 0;
+
+        for(int i=0;i<freeRects.size();++i) {
+            const FreeRect &aFree = freeRects[i];
+            for(int turn=0;turn<(allowRotation ? 2 : 1);++turn) {
+                double rw = turn ? h : w;
+                double rh = turn ? w : h;
+                if(rw > aFree.width + PACK_TOL || rh > aFree.height + PACK_TOL)
+                    continue;
+                double area = aFree.width*aFree.height;
+                if(area < bestArea) {
+                    bestArea = area;
+                    bestIndex = i;
+                    bestW = rw;
+                    bestH = rh;
+                    result.rotated = turn;
+                }
+            }
+        }
+        if(bestIndex == -1)
+            return false;
+
+        FreeRect f = freeRects.takeAt(bestIndex);
+        result.x = f.x;
+        result.y = f.y;
+
+        // the cut goes along the shorter leftover, which keeps the larger piece whole
+        const double leftW = f.width - bestW;
+        const double leftH = f.height - bestH;
+        FreeRect right, top;
+        if(leftW < leftH) {
+            right = {f.x+bestW,f.y,leftW,bestH};
+            top = {f.x,f.y+bestH,f.width,leftH};
+        }
+        else {
+            right = {f.x+bestW,f.y,leftW,f.height};
+            top = {f.x,f.y+bestH,bestW,leftH};
+        }
+        if(right.width > PACK_TOL && right.height > PACK_TOL)
+            freeRects.append(right);
+        if(top.width > PACK_TOL && top.height > PACK_TOL)
+            freeRects.append(top);
+        return true;
+    }
+
+private:
+    QVector<FreeRect> freeRects;
+};
+
+Bin *MakeBin(LB_RectPacker::Method method, double binWid, double binHei)
+{
+    switch(method) {
+    case LB_RectPacker::Skyline:
+        return new SkylineBin(binWid,binHei);
+    case LB_RectPacker::Guillotine:
+        return new GuillotineBin(binWid,binHei);
+    default:
+        return new MaxRectsBin(binWid,binHei);
+    }
+}
+
+}
+
+LB_RectPacker::LB_RectPacker(double binWidth, double binHeight, bool allowRotation) :
+    binWidth(binWidth),
+    binHeight(binHeight),
+    allowRotation(allowRotation)
+{
+}
+
+QVector<LB_PackedRect> LB_RectPacker::Pack(const QVector<LB_PackRect> &rects, Method method)
+{
+    lastMethod = method;
+    binNb = 0;
+
+    // larger first, those that can't fit an empty bin are left out
+    QVector<LB_PackRect> waiting;
+    foreach(const LB_PackRect &aRect,rects) {
+        bool fits = aRect.width <= binWidth + PACK_TOL && aRect.height <= binHeight + PACK_TOL;
+        bool fitsTurned = allowRotation && aRect.height <= binWidth + PACK_TOL && aRect.width <= binHeight + PACK_TOL;
+        if(fits || fitsTurned)
+            waiting.append(aRect);
+    }
+    std::stable_sort(waiting.begin(),waiting.end(),[](const LB_PackRect &a, const LB_PackRect &b) {
+        return a.width*a.height > b.width*b.height;
+    });
+
+    QVector<LB_PackedRect> result;
+    result.reserve(waiting.size());
+    QVector<LB_PackRect> next;
+    while(!waiting.isEmpty()) {
+        QScopedPointer<Bin> aBin(MakeBin(method,binWidth,binHeight));
+        next.clear();
+        foreach(const LB_PackRect &aRect,waiting) {
+            LB_PackedRect placed;
+            if(aBin->Insert(aRect.width,aRect.height,allowRotation,placed)) {
+                placed.id = aRect.id;
+                placed.bin = binNb;
+                result.append(placed);
+            }
+            else {
+                next.append(aRect);
+            }
+        }
+        binNb++;
+        waiting.swap(next);
+    }
+    return result;
+}
+
+QVector<LB_PackedRect> LB_RectPacker::PackBest(const QVector<LB_PackRect> &rects)
+{
+    QHash<int,double> areas;
+    foreach(const LB_PackRect &aRect,rects) {
+        areas.insert(aRect.id,aRect.width*aRect.height);
+    }
+
+    QVector<LB_PackedRect> best;
+    int bestBins = 0;
+    double bestLastArea = 0;
+    Method bestMethod = MaxRects;
+
+    const Method methods[] = {MaxRects,Skyline,Guillotine};
+    for(Method aMethod : methods) {
+        QVector<LB_PackedRect> packed = Pack(rects,aMethod);
+
+        // fewer bins first, then the emptier last bin, which leaves more to the next parts
+        double lastArea = 0;
+        foreach(const LB_PackedRect &aPacked,packed) {
+            if(aPacked.bin == binNb-1)
+                lastArea += areas.value(aPacked.id);
+        }
+        if(best.isEmpty() || binNb < bestBins || (binNb == bestBins && lastArea < bestLastArea)) {
+            best = packed;
+            bestBins = binNb;
+            bestLastArea = lastArea;
+            bestMethod = aMethod;
+        }
+    }
+
+    binNb = bestBins;
+    lastMethod = bestMethod;
+    return best;
+}
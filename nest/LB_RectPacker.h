@@ -0,0 +1,60 @@
+#ifndef LB_RECTPACKER_H
+#define LB_RECTPACKER_H
+
+#include <QVector>
+
+// a rectangle to pack, id is the caller's
+struct LB_PackRect
+{
+    int id = -1;
+    double width = 0;
+    double height = 0;
+};
+
+// where a rectangle went: bin, lower corner, and whether it was turned by 90 degree
+struct LB_PackedRect
+{
+    int id = -1;
+    int bin = -1;
+    double x = 0;
+    double y = 0;
+    bool rotated = false;
+};
+
+// packs axis-aligned rectangles into bins of one size, without any NFP
+// the bins are filled one after the other like the strips of the nest:
+// the rectangles are tried in decreasing area and those that don't fit wait for the next bin
+class LB_RectPacker
+{
+public:
+    enum Method {
+        MaxRects,   // best short side fit on the maximal free rectangles
+        Skyline,    // bottom left on the skyline
+        Guillotine  // best area fit, split along the shorter leftover axis
+    };
+
+    LB_RectPacker(double binWidth, double binHeight, bool allowRotation);
+
+    // rectangles larger than an empty bin are left out of the result
+    QVector<LB_PackedRect> Pack(const QVector<LB_PackRect> &rects, Method method);
+    // runs every method and keeps the result using the fewest bins
+    QVector<LB_PackedRect> PackBest(const QVector<LB_PackRect> &rects);
+
+    // bins used by the last Pack()
+    int BinNumber() const {
+        return binNb;
+    }
+    Method LastMethod() const {
+        return lastMethod;
+    }
+
+private:
+    double binWidth;
+    double binHeight;
+    bool allowRotation;
+
+    int binNb = 0;
+    Method lastMethod = MaxRects;
+};
+
+#endif // LB_RECTPACKER_H
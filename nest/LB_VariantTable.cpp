@@ -0,0 +1,76 @@
+#include "LB_VariantTable.h"
+
+#include <QtConcurrent>
+
+namespace {
+
+// two angles closer than this are the same orientation
+const double ANGLE_TOL = 1e-6;
+
+}
+
+QVector<double> LB_VariantTable::Angles(double step)
+{
+    QVector<double> result;
+    result.append(0);
+    if(step <= 0)
+        return result;
+
+    for(int k=1;k*step<360-ANGLE_TOL;++k) {
+        result.append(k*step);
+    }
+    return result;
+}
+
+void LB_VariantTable::Build(const QVector<LB_Polygon2D> &parts, const QVector<double> &angleVec, bool threaded)
+{
+    angles = angleVec;
+    if(angles.isEmpty())
+        angles.append(0);
+
+    // every variant is written to its own slot
+    variants.resize(parts.size()*angles.size());
+    QVector<int> index(variants.size());
+    for(int i=0;i<index.size();++i) {
+        index[i] = i;
+    }
+    auto build = [&](int id) {
+        LB_Polygon2D poly = parts[PartID(id)];
+        if(Angle(id) != 0)
+            poly.Rotate(Angle(id));
+        poly.SetPartID(PartID(id));
+        poly.UpdateCache();
+        variants[id] = poly;
+    };
+    if(threaded) {
+        QtConcurrent::blockingMap(index,build);
+    }
+    else {
+        foreach(int id,index) {
+            build(id);
+        }
+    }
+}
+
+void LB_VariantTable::Clear()
+{
+    angles.clear();
+    variants.clear();
+}
+
+int LB_VariantTable::FindVariant(int partID, double angle) const
+{
+    if(partID < 0 || angles.isEmpty() || partID >= variants.size()/angles.size())
+        return -1;
+
+    // the same orientation may come back as angle+360 or angle-360
+    angle = std::fmod(angle,360.0);
+    if(angle < 0)
+        angle += 360;
+    for(int k=0;k<angles.size();++k) {
+        double diff = std::fabs(angle - angles[k]);
+        if(diff < ANGLE_TOL || std::fabs(diff - 360) < ANGLE_TOL)
+            return VariantID(partID,k);
+    }
+    return -1;
+}
@@ -0,0 +1,56 @@
+#ifndef LB_VARIANTTABLE_H
+#define LB_VARIANTTABLE_H
+
+#include <QVector>
+
+#include "LB_Polygon2D.h"
+using namespace Shape2D;
+
+// every part in each orientation the nest may try, rotated once per job
+// the variants are stored one part after the other: part p turned by Angles()[k] has id p*Count()+k,
+// and each one has its bounds, hull and hash cached, so trying an orientation costs no geometry work
+class LB_VariantTable
+{
+public:
+    LB_VariantTable() {}
+
+    // 0, step, 2*step ... below 360 degree, only 0 if step isn't positive
+    static QVector<double> Angles(double step);
+
+    // the parts are rotated about the origin, in parallel if threaded, angles[0] should be 0
+    void Build(const QVector<LB_Polygon2D> &parts, const QVector<double> &angleVec, bool threaded = true);
+    void Clear();
+
+    // variants per part
+    int Count() const {
+        return angles.size();
+    }
+    int Size() const {
+        return variants.size();
+    }
+    const QVector<double> &Angles() const {
+        return angles;
+    }
+
+    int VariantID(int partID, int k) const {
+        return partID*angles.size() + k;
+    }
+    // the variant of partID turned by angle, -1 if the table doesn't have it
+    int FindVariant(int partID, double angle) const;
+
+    const LB_Polygon2D &Variant(int id) const {
+        return variants[id];
+    }
+    int PartID(int id) const {
+        return id/angles.size();
+    }
+    double Angle(int id) const {
+        return angles[id%angles.size()];
+    }
+
+private:
+    QVector<double> angles;
+    QVector<LB_Polygon2D> variants;
+};
+
+#endif // LB_VARIANTTABLE_H
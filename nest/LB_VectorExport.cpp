@@ -0,0 +1,186 @@
+#include "LB_VectorExport.h"
+#include "LB_NestIO.h"
+
+#include <QSaveFile>
+#include <QTextStream>
+
+static QString Num(double v)
+{
+    return QString::number(v,'g',12);
+}
+
+LB_VectorExport::LB_VectorExport()
+{
+}
+
+bool LB_VectorExport::Open(const QString &fileName, const LB_NestConfig &aConfig, const QVector<LB_Polygon2D> &partVec)
+{
+    if(fileName.endsWith(".svg",Qt::CaseInsensitive)) {
+        format = Svg;
+    }
+    else if(fileName.endsWith(".dxf",Qt::CaseInsensitive)) {
+        format = Dxf;
+    }
+    else if(fileName.endsWith(".json",Qt::CaseInsensitive)) {
+        format = Json;
+    }
+    else {
+        errorString = QString("unknown vector format of %1").arg(fileName);
+        return false;
+    }
+
+    this->fileName = fileName;
+    config = aConfig;
+    parts = partVec;
+    stripID = -1;
+    current.clear();
+    stripsWritten = 0;
+    errorString.clear();
+    return true;
+}
+
+bool LB_VectorExport::Add(const LB_Placement &placement)
+{
+    if(placement.stripID < stripID) {
+        errorString = QString("strip %1 is already written").arg(placement.stripID);
+        return false;
+    }
+
+    bool ok = true;
+    if(placement.stripID > stripID) {
+        ok = WriteStrip();
+        stripID = placement.stripID;
+    }
+    current.append(placement);
+    return ok;
+}
+
+bool LB_VectorExport::Add(const QVector<LB_Placement> &placements)
+{
+    bool ok = true;
+    foreach(const LB_Placement &aPlacement,placements) {
+        ok = Add(aPlacement) && ok;
+    }
+    return ok;
+}
+
+bool LB_VectorExport::Finish()
+{
+    return WriteStrip();
+}
+
+bool LB_VectorExport::WriteStrip()
+{
+    if(current.isEmpty())
+        return true;
+
+    QByteArray content;
+    switch(format) {
+    case Svg:
+        content = SvgStrip();
+        break;
+    case Dxf:
+        content = DxfStrip();
+        break;
+    case Json:
+        content = JsonStrip();
+        break;
+    }
+    current.clear();
+
+    // renamed into place when complete, a reader never sees half a strip
+    QString stripName = NestIO::StripFileName(fileName,stripID);
+    QSaveFile file(stripName);
+    if(!file.open(QIODevice::WriteOnly) || file.write(content) != content.size() || !file.commit()) {
+        errorString = QString("cannot write %1").arg(stripName);
+        return false;
+    }
+    stripsWritten++;
+    return true;
+}
+
+QByteArray LB_VectorExport::SvgStrip() const
+{
+    QByteArray result;
+    QTextStream out(&result);
+
+    const QString wid = Num(config.StripWidth());
+    const QString hei = Num(config.StripHeight());
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << wid << "mm\" height=\"" << hei
+        << "mm\" viewBox=\"0 0 " << wid << ' ' << hei << "\">\n"
+        << "<rect id=\"strip-" << stripID << "\" width=\"" << wid << "\" height=\"" << hei
+        << "\" fill=\"none\" stroke=\"red\"/>\n";
+
+    foreach(const LB_Placement &aPlacement,current) {
+        LB_Polygon2D poly = aPlacement.Apply(parts[aPlacement.partID]);
+        out << "<path id=\"part-" << aPlacement.partID << "\" fill=\"none\" stroke=\"black\" d=\"";
+        for(int i=0;i<poly.size();++i) {
+            out << (i == 0 ? "M" : " L") << Num(poly[i].X()) << ' ' << Num(poly[i].Y());
+        }
+        out << " Z\"/>\n";
+    }
+    out << "</svg>\n";
+    out.flush();
+    return result;
+}
+
+QByteArray LB_VectorExport::DxfStrip() const
+{
+    // R12 entities section, readable by every CAM
+    QByteArray result;
+    QTextStream out(&result);
+
+    out << "0\nSECTION\n2\nENTITIES\n";
+
+    const double wid = config.StripWidth();
+    const double hei = config.StripHeight();
+    const double sheet[4][2] = {{0,0},{wid,0},{wid,hei},{0,hei}};
+    out << "0\nPOLYLINE\n8\nSHEET\n66\n1\n70\n1\n";
+    for(int i=0;i<4;++i) {
+        out << "0\nVERTEX\n8\nSHEET\n10\n" << Num(sheet[i][0]) << "\n20\n" << Num(sheet[i][1]) << '\n';
+    }
+    out << "0\nSEQEND\n8\nSHEET\n";
+
+    foreach(const LB_Placement &aPlacement,current) {
+        LB_Polygon2D poly = aPlacement.Apply(parts[aPlacement.partID]);
+        const QString layer = QString("PART_%1").arg(aPlacement.partID);
+        out << "0\nPOLYLINE\n8\n" << layer << "\n66\n1\n70\n1\n";
+        for(int i=0;i<poly.size();++i) {
+            out << "0\nVERTEX\n8\n" << layer << "\n10\n" << Num(poly[i].X()) << "\n20\n" << Num(poly[i].Y()) << '\n';
+        }
+        out << "0\nSEQEND\n8\n" << layer << '\n';
+    }
+
+    out << "0\nENDSEC\n0\nEOF\n";
+    out.flush();
+    return result;
+}
+
+QByteArray LB_VectorExport::JsonStrip() const
+{
+    QByteArray result;
+    QTextStream out(&result);
+
+    out << "{\"strip\":" << stripID
+        << ",\"width\":" << Num(config.StripWidth())
+        << ",\"height\":" << Num(config.StripHeight())
+        << ",\"parts\":[";
+    for(int n=0;n<current.size();++n) {
+        const LB_Placement &aPlacement = current[n];
+        LB_Polygon2D poly = aPlacement.Apply(parts[aPlacement.partID]);
+        out << (n == 0 ? "" : ",")
+            << "{\"part\":" << aPlacement.partID
+            << ",\"rotation\":" << Num(aPlacement.rotation)
+            << ",\"dx\":" << Num(aPlacement.dx)
+            << ",\"dy\":" << Num(aPlacement.dy)
+            << ",\"points\":[";
+        for(int i=0;i<poly.size();++i) {
+            out << (i == 0 ? "[" : ",[") << Num(poly[i].X()) << ',' << Num(poly[i].Y()) << ']';
+        }
+        out << "]}";
+    }
+    out << "]}\n";
+    out.flush();
+    return result;
+}
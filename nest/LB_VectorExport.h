@@ -0,0 +1,62 @@
+#ifndef LB_VECTOREXPORT_H
+#define LB_VECTOREXPORT_H
+
+#include <QVector>
+#include <QString>
+
+#include "LB_Polygon2D.h"
+#include "LB_NestConfig.h"
+#include "LB_Placement.h"
+using namespace Shape2D;
+using namespace NestConfig;
+
+// writes the placed shapes as vectors, one file per strip (see NestIO::StripFileName)
+// the placements are fed as they are published, strip by strip: a strip is written
+// as soon as the first placement of the next one arrives, so only one strip is held
+// in memory and the file of a finished strip appears while the nest goes on
+class LB_VectorExport
+{
+public:
+    enum Format {
+        Svg,
+        Dxf,
+        Json
+    };
+
+    LB_VectorExport();
+
+    // the format is taken from the suffix of fileName (.svg, .dxf or .json)
+    bool Open(const QString &fileName, const LB_NestConfig &aConfig, const QVector<LB_Polygon2D> &partVec);
+
+    bool Add(const LB_Placement &placement);
+    bool Add(const QVector<LB_Placement> &placements);
+    // writes the last strip
+    bool Finish();
+
+    int StripsWritten() const {
+        return stripsWritten;
+    }
+    QString ErrorString() const {
+        return errorString;
+    }
+
+private:
+    bool WriteStrip();
+    QByteArray SvgStrip() const;
+    QByteArray DxfStrip() const;
+    QByteArray JsonStrip() const;
+
+    QString fileName;
+    Format format = Svg;
+    LB_NestConfig config;
+    QVector<LB_Polygon2D> parts;
+
+    // the strip being filled
+    int stripID = -1;
+    QVector<LB_Placement> current;
+
+    int stripsWritten = 0;
+    QString errorString;
+};
+
+#endif // LB_VECTOREXPORT_H
@@ -0,0 +1,20 @@
+QT += core gui concurrent
+QT -= widgets
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = NFPRegress
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include($$PWD/../nest/LB_Nest.pri)
+
+INCLUDEPATH += $$PWD/../nest
+
+HEADERS += \
+    RegressSet.h
+
+SOURCES += \
+    RegressSet.cpp \
+    main.cpp
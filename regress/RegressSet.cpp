@@ -0,0 +1,179 @@
+#include "RegressSet.h"
+
+#include <cmath>
+
+#include "LB_NFPHandle.h"
+#include "LB_NFPCache.h"
+
+namespace RegressSet {
+
+namespace {
+
+const char *kindNames[] = {"outer","inner","reflected"};
+
+// linear congruential generator, rand() differs between platforms
+class Random
+{
+public:
+    explicit Random(quint32 seed) : state(seed) {}
+
+    int Bounded(int n) {
+        state = state*1664525u + 1013904223u;
+        return int((state >> 8) % quint32(n));
+    }
+
+private:
+    quint32 state;
+};
+
+// n points around the origin at radius r, every second one pulled in for a star
+// the points are rounded, so the shape doesn't depend on the last bits of sin and cos
+LB_Polygon2D RandomPolygon(Random &random, int n, double r, bool star)
+{
+    LB_Polygon2D aPoly;
+    for(int k=0;k<n;++k) {
+        double angle = 2*M_PI*k/n;
+        double radius = (star && k%2) ? r*0.5 : r*(0.7 + 0.3*random.Bounded(100)/100.0);
+        aPoly.push_back(LB_Coord2D(std::round(radius*cos(angle)),std::round(radius*sin(angle))));
+    }
+    return aPoly;
+}
+
+LB_Polygon2D Rectangle(double width, double height)
+{
+    return LB_Polygon2D({LB_Coord2D(0,0),LB_Coord2D(width,0),LB_Coord2D(width,height),LB_Coord2D(0,height)});
+}
+
+}
+
+QVector<Case> Cases()
+{
+    QVector<Case> cases;
+
+    Random random(11);
+    for(int t=0;t<300;++t) {
+        // one draw per statement, the order arguments are evaluated in is up to the compiler
+        int n = 3 + random.Bounded(12);
+        double r = 20 + random.Bounded(40);
+        bool star = random.Bounded(2);
+        LB_Polygon2D A = RandomPolygon(random,n,r,star);
+        n = 3 + random.Bounded(12);
+        r = 10 + random.Bounded(30);
+        star = random.Bounded(2);
+        LB_Polygon2D B = RandomPolygon(random,n,r,star);
+        if(t%7 == 0)
+            A = Rectangle(100,60);
+        if(t%5 == 0)
+            B = Rectangle(30,20);
+
+        cases.push_back({t,OUTER,A,B});
+        if(t%3 == 0)
+            cases.push_back({t,INNER,A,B});
+        if(t%3 == 1)
+            cases.push_back({t,REFLECTED,A,B});
+    }
+
+    // a rectangle which doesn't fit into a small triangle
+    LB_Polygon2D triangle({LB_Coord2D(0,0),LB_Coord2D(40,0),LB_Coord2D(0,30)});
+    cases.push_back({1000,INNER,triangle,Rectangle(30,20)});
+    // exact fits, every contact is along a whole edge
+    cases.push_back({1001,INNER,Rectangle(100,60),Rectangle(100,60)});
+    cases.push_back({1002,OUTER,Rectangle(100,60),Rectangle(100,60)});
+    // an L around a square which fits into its corner
+    LB_Polygon2D shapeL({LB_Coord2D(0,0),LB_Coord2D(100,0),LB_Coord2D(100,30),
+                         LB_Coord2D(30,30),LB_Coord2D(30,100),LB_Coord2D(0,100)});
+    cases.push_back({1003,OUTER,shapeL,Rectangle(30,30)});
+    cases.push_back({1004,REFLECTED,shapeL,Rectangle(30,30)});
+    // a comb whose gaps are as wide as the part, the orbit finds no NFP for it yet
+    LB_Polygon2D comb({LB_Coord2D(0,0),LB_Coord2D(100,0),LB_Coord2D(100,80),LB_Coord2D(80,80),
+                       LB_Coord2D(80,20),LB_Coord2D(60,20),LB_Coord2D(60,80),LB_Coord2D(40,80),
+                       LB_Coord2D(40,20),LB_Coord2D(20,20),LB_Coord2D(20,80),LB_Coord2D(0,80)});
+    cases.push_back({1005,OUTER,comb,Rectangle(20,40)});
+    cases.push_back({1006,OUTER,comb,triangle});
+
+    return cases;
+}
+
+QByteArray Dump(const Case &aCase)
+{
+    QVector<LB_Polygon2D> nfp;
+    switch(aCase.kind) {
+    case OUTER:
+        nfp = NFPHandle::NoFitPolygon(aCase.A,aCase.B,false,false);
+        break;
+    case INNER:
+        nfp = NFPHandle::NoFitPolygon(aCase.A,aCase.B,true,false);
+        break;
+    case REFLECTED: {
+        NFPHandle::LB_NFPCache cache;
+        cache.Insert(aCase.A,aCase.B,false,false,NFPHandle::NoFitPolygon(aCase.A,aCase.B,false,false));
+        cache.Find(aCase.B,aCase.A,false,false,nfp);
+        break;
+    }
+    }
+
+    QByteArray line = QByteArray::number(aCase.id) + ' ' + kindNames[aCase.kind];
+    foreach(const LB_Polygon2D &aPoly,nfp) {
+        line += " [" + QByteArray::number(aPoly.size()) + ']';
+        foreach(const LB_Coord2D &pnt,aPoly) {
+            line += ' ' + QByteArray::number(pnt.X(),'f',6) + ',' + QByteArray::number(pnt.Y(),'f',6);
+        }
+    }
+    return line;
+}
+
+QByteArray LineKey(const QByteArray &line)
+{
+    QList<QByteArray> fields = line.split(' ');
+    if(fields.size() < 2)
+        return QByteArray();
+    return fields[0] + ' ' + fields[1];
+}
+
+bool SameDump(const QByteArray &line, const QByteArray &reference, double tolerance)
+{
+    QList<QByteArray> fields = line.split(' ');
+    QList<QByteArray> refFields = reference.split(' ');
+    if(fields.size() != refFields.size())
+        return false;
+
+    for(int k=0;k<fields.size();++k) {
+        QList<QByteArray> coords = fields[k].split(',');
+        QList<QByteArray> refCoords = refFields[k].split(',');
+        // the key and the point counts are compared as they are
+        if(coords.size() != 2 || refCoords.size() != 2) {
+            if(fields[k] != refFields[k])
+                return false;
+            continue;
+        }
+        if(std::fabs(coords[0].toDouble() - refCoords[0].toDouble()) > tolerance
+                || std::fabs(coords[1].toDouble() - refCoords[1].toDouble()) > tolerance)
+            return false;
+    }
+    return true;
+}
+
+QVector<QByteArray> FailedShapeChecks()
+{
+    QVector<QByteArray> failed;
+
+    // PackRectangles puts every part IsRectangle accepts on a strip as its box
+    LB_Polygon2D rect = Rectangle(40,30);
+    if(!rect.IsRectangle())
+        failed.push_back("rectangle: not a rectangle");
+    LB_Polygon2D closed({LB_Coord2D(0,0),LB_Coord2D(40,0),LB_Coord2D(40,30),LB_Coord2D(0,30),
+                         LB_Coord2D(0,0)});
+    if(!closed.IsRectangle())
+        failed.push_back("rectangle with a closing point: not a rectangle");
+    // every point of these is a corner of its box
+    LB_Polygon2D triangle({LB_Coord2D(0,0),LB_Coord2D(40,0),LB_Coord2D(0,30)});
+    if(triangle.IsRectangle())
+        failed.push_back("right triangle: taken for a rectangle");
+    LB_Polygon2D bowtie({LB_Coord2D(0,0),LB_Coord2D(40,30),LB_Coord2D(40,0),LB_Coord2D(0,30)});
+    if(bowtie.IsRectangle())
+        failed.push_back("crossed quadrilateral: taken for a rectangle");
+
+    return failed;
+}
+
+}
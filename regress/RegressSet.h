@@ -0,0 +1,45 @@
+#ifndef REGRESSSET_H
+#define REGRESSSET_H
+
+#include <QVector>
+#include <QByteArray>
+
+#include "LB_Polygon2D.h"
+using namespace Shape2D;
+
+// the fixed set of NFPs a change of the orbiting or of the NFP cache is checked against
+namespace RegressSet {
+
+enum CaseKind {
+    OUTER,
+    INNER,
+    // the outer NFP of (B,A) as the cache answers it from the one of (A,B)
+    REFLECTED
+};
+
+struct Case {
+    int id;
+    CaseKind kind;
+    LB_Polygon2D A;
+    LB_Polygon2D B;
+};
+
+// random pairs from a seeded generator that gives the same shapes on every platform,
+// and a few made by hand
+QVector<Case> Cases();
+
+// one line per case, "<id> <kind>" and then every NFP as " [<points>] x,y x,y ..."
+QByteArray Dump(const Case &aCase);
+
+// the id and kind of a dumped line, the key its reference is found by
+QByteArray LineKey(const QByteArray &line);
+
+// true if both lines have the same NFPs, point for point within tolerance
+bool SameDump(const QByteArray &line, const QByteArray &reference, double tolerance);
+
+// checks of single shapes the nest relies on, one line for every check that fails
+QVector<QByteArray> FailedShapeChecks();
+
+}
+
+#endif // REGRESSSET_H
@@ -0,0 +1,89 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QHash>
+#include <QFile>
+
+#include "RegressSet.h"
+
+// dumps the NFPs of the regression set, or compares them with a dump made before a change
+// and runs the shape checks
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc,argv);
+    QCoreApplication::setApplicationName("NFPRegress");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("NFP regression set");
+    parser.addHelpOption();
+    QCommandLineOption dumpOption("dump", "Write the NFPs of the set to this file.", "file");
+    QCommandLineOption compareOption("compare", "Compare the NFPs of the set with this dump.", "file");
+    QCommandLineOption toleranceOption("tolerance", "Largest difference of a point for --compare.", "mm", "1e-6");
+    parser.addOption(dumpOption);
+    parser.addOption(compareOption);
+    parser.addOption(toleranceOption);
+    parser.process(app);
+
+    QTextStream err(stderr);
+    if(parser.isSet(dumpOption) == parser.isSet(compareOption)) {
+        err << "either --dump or --compare is needed\n";
+        return 2;
+    }
+
+    QVector<RegressSet::Case> cases = RegressSet::Cases();
+    QVector<QByteArray> lines;
+    lines.reserve(cases.size());
+    QElapsedTimer timer;
+    timer.start();
+    foreach(const RegressSet::Case &aCase,cases) {
+        lines.push_back(RegressSet::Dump(aCase));
+    }
+    qint64 elapsed = timer.elapsed();
+
+    if(parser.isSet(dumpOption)) {
+        QFile out(parser.value(dumpOption));
+        if(!out.open(QIODevice::WriteOnly)) {
+            err << "cannot write " << parser.value(dumpOption) << '\n';
+            return 2;
+        }
+        foreach(const QByteArray &line,lines) {
+            out.write(line + '\n');
+        }
+        err << lines.size() << " NFPs in " << elapsed << " ms\n";
+        return 0;
+    }
+
+    QFile in(parser.value(compareOption));
+    if(!in.open(QIODevice::ReadOnly)) {
+        err << "cannot read " << parser.value(compareOption) << '\n';
+        return 2;
+    }
+    QHash<QByteArray, QByteArray> reference;
+    while(!in.atEnd()) {
+        QByteArray line = in.readLine().trimmed();
+        if(!line.isEmpty())
+            reference.insert(RegressSet::LineKey(line),line);
+    }
+
+    double tolerance = parser.value(toleranceOption).toDouble();
+    int differ = 0;
+    foreach(const QByteArray &line,lines) {
+        QByteArray key = RegressSet::LineKey(line);
+        auto it = reference.constFind(key);
+        if(it == reference.constEnd()) {
+            err << key << ": not in the reference\n";
+            differ++;
+        }
+        else if(!RegressSet::SameDump(line,it.value(),tolerance)) {
+            err << key << ": differs\n";
+            differ++;
+        }
+    }
+    err << lines.size() << " NFPs in " << elapsed << " ms, " << differ << " differ\n";
+
+    QVector<QByteArray> failed = RegressSet::FailedShapeChecks();
+    foreach(const QByteArray &check,failed) {
+        err << check << '\n';
+    }
+    return (differ || !failed.isEmpty()) ? 1 : 0;
+}
@@ -0,0 +1,29 @@
+QT += core gui network concurrent
+QT -= widgets
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = NFPNestService
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include($$PWD/../nest/LB_Nest.pri)
+
+INCLUDEPATH += $$PWD/../nest
+
+HEADERS += \
+    NestJson.h \
+    NestServer.h \
+    ShardCoordinator.h
+
+SOURCES += \
+    NestJson.cpp \
+    NestServer.cpp \
+    ShardCoordinator.cpp \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
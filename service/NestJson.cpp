@@ -0,0 +1,67 @@
+#include "NestJson.h"
+
+namespace NestJson {
+
+LB_NestConfig ConfigFromJson(const QJsonObject &obj)
+{
+    LB_NestConfig config;
+    config.SetStripWidth(obj.value("stripWidth").toDouble(config.StripWidth()));
+    config.SetStripHeight(obj.value("stripHeight").toDouble(config.StripHeight()));
+    config.SetEnableRotation(obj.value("enableRotation").toBool(config.EnableRotation()));
+    config.SetRotationStep(obj.value("rotationStep").toDouble(config.RotationStep()));
+    config.SetItemGap(obj.value("itemGap").toDouble(config.ItemGap()));
+    return config;
+}
+
+QVector<LB_Polygon2D> PolygonsFromJson(const QJsonArray &array)
+{
+    QVector<LB_Polygon2D> polygons;
+    polygons.reserve(array.size());
+    foreach(const QJsonValue &polyValue,array) {
+        LB_Polygon2D aPoly;
+        foreach(const QJsonValue &pntValue,polyValue.toArray()) {
+            QJsonArray pnt = pntValue.toArray();
+            if(pnt.size() != 2)
+                continue;
+            aPoly.push_back(LB_Coord2D(pnt[0].toDouble(),pnt[1].toDouble()));
+        }
+        if(aPoly.size() >= 3)
+            polygons.push_back(aPoly);
+    }
+    return polygons;
+}
+
+QJsonArray PolygonsToJson(const QVector<LB_Polygon2D> &polygons)
+{
+    QJsonArray array;
+    foreach(const LB_Polygon2D &aPoly,polygons) {
+        QJsonArray points;
+        foreach(const LB_Coord2D &pnt,aPoly) {
+            points.append(QJsonArray{pnt.X(),pnt.Y()});
+        }
+        array.append(QJsonObject{{"strip",aPoly.ID()},{"points",points}});
+    }
+    return array;
+}
+
+QJsonObject ValidationToJson(const LB_ValidationReport &report)
+{
+    QJsonArray overlaps;
+    foreach(const LB_Overlap &anOverlap,report.overlaps) {
+        overlaps.append(QJsonObject{{"strip",anOverlap.stripID},
+                                    {"a",anOverlap.a},
+                                    {"b",anOverlap.b},
+                                    {"depth",anOverlap.depth}});
+    }
+    QJsonArray outside;
+    foreach(int index,report.outside) {
+        outside.append(index);
+    }
+    return QJsonObject{{"valid",report.IsValid()},
+                       {"overlaps",overlaps},
+                       {"outside",outside},
+                       {"pairs",report.checkedPairs},
+                       {"ms",double(report.elapsedMs)}};
+}
+
+}
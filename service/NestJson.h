@@ -0,0 +1,31 @@
+#ifndef NESTJSON_H
+#define NESTJSON_H
+
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "LB_Polygon2D.h"
+#include "LB_NestConfig.h"
+#include "LB_LayoutValidator.h"
+using namespace Shape2D;
+using namespace NestConfig;
+
+// JSON form of the nesting data used by the service
+namespace NestJson {
+
+// missing keys keep their default value
+LB_NestConfig ConfigFromJson(const QJsonObject &obj);
+
+// [[[x,y],...],...], polygons with less than 3 points are dropped
+QVector<LB_Polygon2D> PolygonsFromJson(const QJsonArray &array);
+
+// [{"strip":id,"points":[[x,y],...]},...]
+QJsonArray PolygonsToJson(const QVector<LB_Polygon2D> &polygons);
+
+// {"valid":bool,"overlaps":[{"strip":id,"a":i,"b":j,"depth":d},...],"outside":[i,...],"pairs":n,"ms":t}
+// a, b and the outside indexes refer to the placements of the result
+QJsonObject ValidationToJson(const LB_ValidationReport &report);
+
+}
+
+#endif // NESTJSON_H
@@ -0,0 +1,402 @@
+#include "NestServer.h"
+#include "NestJson.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QtConcurrent>
+
+using namespace NestJson;
+
+namespace {
+
+QJsonObject Error(const QString &message)
+{
+    return QJsonObject{{"ok",false},{"error",message}};
+}
+
+}
+
+NestServer::NestServer(QObject *parent) :
+    QObject(parent),
+    cache(new LB_NFPCache),
+    costModel(new LB_NFPCostModel)
+{
+    clock.start();
+    connect(&server,&QLocalServer::newConnection,this,&NestServer::onNewConnection);
+}
+
+NestServer::~NestServer()
+{
+    pool.waitForDone();
+}
+
+bool NestServer::Listen(const QString &name)
+{
+    // a socket file left behind by a crashed server would block the name
+    QLocalServer::removeServer(name);
+    return server.listen(name);
+}
+
+bool NestServer::OpenStore(const QString &fileName)
+{
+    QSharedPointer<LB_NFPStore> store(new LB_NFPStore);
+    if(!store->Open(fileName))
+        return false;
+    cache->SetStore(store);
+    return true;
+}
+
+void NestServer::SetWorkerNumber(int number)
+{
+    if(number > 0)
+        pool.setMaxThreadCount(number);
+}
+
+void NestServer::SetCacheCapacity(qint64 points)
+{
+    cache->SetCapacity(points);
+}
+
+void NestServer::onNewConnection()
+{
+    while(QLocalSocket *socket = server.nextPendingConnection()) {
+        connect(socket,&QLocalSocket::readyRead,this,&NestServer::onReadyRead);
+        connect(socket,&QLocalSocket::disconnected,socket,&QObject::deleteLater);
+    }
+}
+
+void NestServer::onReadyRead()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+    if(!socket)
+        return;
+
+    while(socket->canReadLine()) {
+        QByteArray line = socket->readLine().trimmed();
+        if(line.isEmpty())
+            continue;
+
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(line,&parseError);
+        QJsonObject reply = doc.isObject() ? HandleRequest(doc.object())
+                                           : Error(parseError.errorString());
+        socket->write(QJsonDocument(reply).toJson(QJsonDocument::Compact));
+        socket->write("\n");
+    }
+}
+
+QJsonObject NestServer::HandleRequest(const QJsonObject &request)
+{
+    QString cmd = request.value("cmd").toString();
+    if(cmd == "submit")
+        return Submit(request);
+    if(cmd == "status")
+        return Status(request);
+    if(cmd == "result")
+        return Result(request);
+    if(cmd == "cancel")
+        return Cancel(request);
+    if(cmd == "metrics")
+        return Metrics();
+    if(cmd == "compact")
+        return Compact();
+    return Error(QString("unknown command '%1'").arg(cmd));
+}
+
+QJsonObject NestServer::Submit(const QJsonObject &request)
+{
+    Job aJob;
+    aJob.id = nextJobId++;
+    aJob.priority = request.value("priority").toInt(0);
+    aJob.config = ConfigFromJson(request.value("config").toObject());
+    aJob.polygons = PolygonsFromJson(request.value("polygons").toArray());
+    aJob.checkpoint = request.value("checkpoint").toString();
+    aJob.checkpointInterval = request.value("checkpointIntervalMs").toInt(60000);
+    aJob.resume = request.value("resume").toString();
+    aJob.exportFile = request.value("export").toString();
+    aJob.compactBudget = qMax(0,request.value("compactMs").toInt(0));
+    aJob.validate = request.value("validate").toBool(false);
+    aJob.control.reset(new LB_NestControl);
+    aJob.submitted = clock.elapsed();
+
+    if(aJob.polygons.isEmpty() && aJob.resume.isEmpty())
+        return Error("no valid polygon in the job");
+
+    jobs.insert(aJob.id,aJob);
+    pending[aJob.priority].enqueue(aJob.id);
+    pendingNb++;
+
+    Schedule();
+
+    return QJsonObject{{"ok",true},{"job",aJob.id}};
+}
+
+QJsonObject NestServer::Status(const QJsonObject &request) const
+{
+    auto it = jobs.constFind(request.value("job").toInt());
+    if(it == jobs.constEnd())
+        return Error("unknown job");
+
+    static const char *stateNames[] = {"queued","running","done","failed"};
+    QJsonObject reply{{"ok",true},{"job",it->id},{"state",stateNames[it->state]}};
+    if(it->baselineStrips > 0)
+        reply.insert("baselineStrips",it->baselineStrips);
+    if(it->state == DONE) {
+        reply.insert("strips",it->stripNb);
+        reply.insert("complete",it->complete);
+        reply.insert("baseline",it->baseline);
+    }
+    if(it->state == FAILED)
+        reply.insert("error",it->error);
+    return reply;
+}
+
+QJsonObject NestServer::Result(const QJsonObject &request)
+{
+    auto it = jobs.find(request.value("job").toInt());
+    if(it == jobs.end())
+        return Error("unknown job");
+    if(it->state == FAILED) {
+        QJsonObject reply = Error(it->error);
+        reply.insert("job",it->id);
+        jobs.erase(it);
+        return reply;
+    }
+    if(it->state != DONE) {
+        if(it->baselineStrips == 0)
+            return Error("job not finished");
+
+        // a first layout while the nest goes on, the job is kept
+        return QJsonObject{{"ok",true},
+                           {"job",it->id},
+                           {"strips",it->baselineStrips},
+                           {"complete",true},
+                           {"baseline",true},
+                           {"placements",PolygonsToJson(it->baselinePlaced)}};
+    }
+
+    QJsonObject reply{{"ok",true},
+                      {"job",it->id},
+                      {"strips",it->stripNb},
+                      {"complete",it->complete},
+                      {"baseline",it->baseline},
+                      {"placements",PolygonsToJson(it->placed)}};
+    if(!it->validation.isEmpty())
+        reply.insert("validation",it->validation);
+    jobs.erase(it);
+    return reply;
+}
+
+QJsonObject NestServer::Cancel(const QJsonObject &request)
+{
+    auto it = jobs.find(request.value("job").toInt());
+    if(it == jobs.end())
+        return Error("unknown job");
+
+    if(it->state == QUEUED) {
+        auto queue = pending.find(it->priority);
+        queue->removeOne(it->id);
+        if(queue->isEmpty())
+            pending.erase(queue);
+        pendingNb--;
+
+        it->state = DONE;
+        it->polygons.clear();
+        PrefetchNext();
+    }
+    else if(it->state == RUNNING) {
+        // the worker notices within one orbit step and reports the partial layout
+        it->control->Cancel();
+    }
+    return QJsonObject{{"ok",true},{"job",it->id}};
+}
+
+QJsonObject NestServer::Compact()
+{
+    QSharedPointer<LB_NFPStore> store = cache->Store();
+    if(!store || !store->IsWritable())
+        return Error("no NFP store written by this server");
+    // the running jobs wait on the store meanwhile
+    if(!store->Compact())
+        return Error(store->ErrorString());
+    return QJsonObject{{"ok",true},{"storeSize",store->Size()}};
+}
+
+QJsonObject NestServer::Metrics() const
+{
+    QJsonObject reply{{"ok",true},
+                      {"queueDepth",pendingNb},
+                      {"running",running},
+                      {"workers",pool.maxThreadCount()},
+                      {"finished",finishedNb},
+                      {"cacheSize",cache->Size()},
+                      {"cacheHits",cache->Hits()},
+                      {"cacheMisses",cache->Misses()},
+                      {"cacheReflections",cache->Reflections()},
+                      {"cachePoints",double(cache->Points())},
+                      {"cacheEvictions",cache->Evictions()},
+                      {"nfpTimed",costModel->Samples()}};
+    if(cache->Store()) {
+        reply.insert("storeSize",cache->Store()->Size());
+        reply.insert("storeHits",cache->StoreHits());
+    }
+    if(finishedNb > 0) {
+        reply.insert("avgWaitMs",double(totalWait)/finishedNb);
+        reply.insert("maxWaitMs",double(maxWait));
+        reply.insert("avgRunMs",double(totalRun)/finishedNb);
+        reply.insert("maxRunMs",double(maxRun));
+    }
+    return reply;
+}
+
+void NestServer::Schedule()
+{
+    // hand out as many jobs as there are idle workers, highest priority first
+    while(pendingNb > 0 && running < pool.maxThreadCount()) {
+        auto top = std::prev(pending.end());
+        int id = top->dequeue();
+        if(top->isEmpty())
+            pending.erase(top);
+        pendingNb--;
+
+        // the job nests the NFPs it needs itself now
+        QSharedPointer<LB_NFPCache> runCache;
+        if(id == prefetchJob) {
+            runCache = prefetch.TakeRunCache();
+            prefetch.Cancel();
+            prefetchJob = 0;
+        }
+
+        Job &aJob = jobs[id];
+        aJob.state = RUNNING;
+        aJob.started = clock.elapsed();
+        running++;
+
+        LB_NestConfig config = aJob.config;
+        QVector<LB_Polygon2D> polygons = aJob.polygons;
+        aJob.polygons.clear();
+        QString checkpoint = aJob.checkpoint;
+        int checkpointInterval = aJob.checkpointInterval;
+        QString resume = aJob.resume;
+        QString exportFile = aJob.exportFile;
+        int compactBudget = aJob.compactBudget;
+        bool validate = aJob.validate;
+
+        QSharedPointer<LB_NFPCache> sharedCache = cache;
+        QSharedPointer<LB_NFPCostModel> sharedModel = costModel;
+        QSharedPointer<LB_NestControl> control = aJob.control;
+        QtConcurrent::run(&pool,[=]() {
+            LB_NestEngine engine(config);
+            QObject::connect(&engine,&LB_NestEngine::BaselineReady,[&]() {
+                int baselineStrips = engine.BaselineStripNumber();
+                QVector<LB_Polygon2D> baselinePlaced = engine.Shapes(engine.Baseline());
+                QMetaObject::invokeMethod(this,[this,id,baselineStrips,baselinePlaced]() {
+                    onJobBaseline(id,baselineStrips,baselinePlaced);
+                },Qt::QueuedConnection);
+            });
+            engine.SetCache(sharedCache);
+            engine.SetRunCache(runCache);
+            engine.SetCostModel(sharedModel);
+            engine.SetControl(control);
+            engine.SetPolygons(polygons);
+            engine.SetCheckpoint(checkpoint,checkpointInterval);
+            engine.SetVectorExport(exportFile);
+            engine.SetCompaction(compactBudget);
+            // a checkpoint which can't be read falls back to the parts of the job, if it has any
+            bool resumed = !resume.isEmpty() && engine.Resume(resume);
+            if(!resumed && polygons.isEmpty()) {
+                QString error = QString("cannot resume from %1").arg(resume);
+                QMetaObject::invokeMethod(this,[this,id,error]() {
+                    onJobFailed(id,error);
+                },Qt::QueuedConnection);
+                return;
+            }
+            if(!resumed)
+                engine.Run();
+
+            // a stopped nest falls back to the bounding box layout, as does a worse one
+            bool baseline = engine.UsesBaseline();
+            int stripNb = engine.BestStripNumber();
+            QVector<LB_Polygon2D> placed = engine.Shapes(engine.BestPlacements());
+            bool complete = engine.IsFinished() || baseline;
+
+            QJsonObject validation;
+            if(validate) {
+                LB_LayoutValidator validator(config.StripWidth(),config.StripHeight());
+                validation = ValidationToJson(validator.Validate(placed));
+            }
+            QMetaObject::invokeMethod(this,[this,id,stripNb,placed,complete,baseline,validation]() {
+                onJobFinished(id,stripNb,placed,complete,baseline,validation);
+            },Qt::QueuedConnection);
+        });
+    }
+
+    // all workers busy, the job waiting longest at the top priority comes next
+    PrefetchNext();
+}
+
+void NestServer::PrefetchNext()
+{
+    int next = pendingNb > 0 ? std::prev(pending.end())->head() : 0;
+    if(next == prefetchJob)
+        return;
+
+    prefetchJob = next;
+    if(next == 0) {
+        prefetch.Cancel();
+        return;
+    }
+    const Job &aJob = jobs[next];
+    prefetch.Start(aJob.config,aJob.polygons,cache);
+}
+
+void NestServer::onJobBaseline(int id, int stripNb, const QVector<LB_Polygon2D> &placed)
+{
+    auto it = jobs.find(id);
+    if(it != jobs.end() && it->state == RUNNING) {
+        it->baselineStrips = stripNb;
+        it->baselinePlaced = placed;
+    }
+}
+
+void NestServer::onJobFailed(int id, const QString &error)
+{
+    running--;
+
+    auto it = jobs.find(id);
+    if(it != jobs.end()) {
+        it->state = FAILED;
+        it->error = error;
+        it->finished = clock.elapsed();
+    }
+
+    Schedule();
+}
+
+void NestServer::onJobFinished(int id, int stripNb, const QVector<LB_Polygon2D> &placed, bool complete, bool baseline,
+                               const QJsonObject &validation)
+{
+    running--;
+
+    auto it = jobs.find(id);
+    if(it != jobs.end()) {
+        it->state = DONE;
+        it->stripNb = stripNb;
+        it->placed = placed;
+        it->complete = complete;
+        it->baseline = baseline;
+        it->validation = validation;
+        it->baselinePlaced.clear();
+        it->finished = clock.elapsed();
+
+        qint64 wait = it->started - it->submitted;
+        qint64 run = it->finished - it->started;
+        finishedNb++;
+        totalWait += wait;
+        totalRun += run;
+        maxWait = qMax(maxWait,wait);
+        maxRun = qMax(maxRun,run);
+    }
+
+    Schedule();
+}
@@ -0,0 +1,135 @@
+#ifndef NESTSERVER_H
+#define NESTSERVER_H
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QHash>
+#include <QMap>
+#include <QQueue>
+
+#include "LB_NestEngine.h"
+#include "LB_NFPPrefetch.h"
+
+// long running nesting service
+// clients talk to it through a local socket, one JSON object per line:
+//   {"cmd":"submit","priority":0,"config":{...},"polygons":[[[x,y],...],...]}  -> {"ok":true,"job":1}
+//       optional: "checkpoint":"file","checkpointIntervalMs":60000 to save the state while running,
+//                 "resume":"file" to continue from a checkpoint instead of nesting "polygons",
+//                 a checkpoint which can't be read falls back to "polygons", without them the job fails
+//                 "export":"file.svg" (.dxf, .json) to write every strip as soon as it is nested
+//                 "compactMs":200 to slide the parts of every strip left and down for at most 200 ms
+//   {"cmd":"status","job":1}   -> state of the job
+//   {"cmd":"result","job":1}   -> placed polygons of a finished job, the job is forgotten afterwards
+//                                 a running job answers with its bounding box layout ("baseline":true)
+//   {"cmd":"cancel","job":1}   -> stops a job, a running one keeps what it has placed so far
+//   {"cmd":"metrics"}          -> queue depth, latencies and cache statistics
+//   {"cmd":"compact"}          -> rewrites the NFP store without its left over records
+// all jobs run on one worker pool and share one NFP cache, optionally backed by a store on disk
+// while jobs wait, the NFPs of the next one are computed into the cache in the background
+class NestServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NestServer(QObject *parent = nullptr);
+    ~NestServer();
+
+    bool Listen(const QString &name);
+    void SetWorkerNumber(int number);
+    // points of all NFPs the shared cache keeps in memory, see LB_NFPCache::SetCapacity()
+    void SetCacheCapacity(qint64 points);
+    // keeps the NFPs in fileName across runs of the server
+    bool OpenStore(const QString &fileName);
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    enum JobState {
+        QUEUED,
+        RUNNING,
+        DONE,
+        // couldn't run at all, error says why and there is no result
+        FAILED
+    };
+
+    struct Job {
+        int id = 0;
+        int priority = 0;
+        JobState state = QUEUED;
+        LB_NestConfig config;
+        QVector<LB_Polygon2D> polygons;
+
+        // optional checkpoint file, and the checkpoint to continue from
+        QString checkpoint;
+        int checkpointInterval = 0;
+        QString resume;
+        // optional vector output, one file per strip
+        QString exportFile;
+        int compactBudget = 0;
+        // check the final layout for overlaps, the report comes with the result
+        bool validate = false;
+
+        QSharedPointer<LB_NestControl> control;
+        int stripNb = 0;
+        QVector<LB_Polygon2D> placed;
+        bool complete = false;
+        // the result is the bounding box layout
+        bool baseline = false;
+        QJsonObject validation;
+        QString error;
+
+        // bounding box layout, known a few ms after the start
+        int baselineStrips = 0;
+        QVector<LB_Polygon2D> baselinePlaced;
+
+        // ms since the server started
+        qint64 submitted = 0;
+        qint64 started = 0;
+        qint64 finished = 0;
+    };
+
+    QJsonObject HandleRequest(const QJsonObject &request);
+    QJsonObject Submit(const QJsonObject &request);
+    QJsonObject Status(const QJsonObject &request) const;
+    QJsonObject Result(const QJsonObject &request);
+    QJsonObject Cancel(const QJsonObject &request);
+    QJsonObject Metrics() const;
+    QJsonObject Compact();
+
+    void Schedule();
+    // prefetches the job which runs next, if it changed
+    void PrefetchNext();
+    void onJobBaseline(int id, int stripNb, const QVector<LB_Polygon2D> &placed);
+    void onJobFailed(int id, const QString &error);
+    void onJobFinished(int id, int stripNb, const QVector<LB_Polygon2D> &placed, bool complete, bool baseline,
+                       const QJsonObject &validation);
+
+    QLocalServer server;
+    QThreadPool pool;
+    QSharedPointer<LB_NFPCache> cache;
+    QSharedPointer<LB_NFPCostModel> costModel;
+    QElapsedTimer clock;
+
+    LB_NFPPrefetch prefetch;
+    int prefetchJob = 0;
+
+    int nextJobId = 1;
+    int running = 0;
+    QHash<int, Job> jobs;
+    // waiting jobs by priority, first in first out within one priority
+    QMap<int, QQueue<int>> pending;
+    int pendingNb = 0;
+
+    // latency of the finished jobs
+    int finishedNb = 0;
+    qint64 totalWait = 0;
+    qint64 maxWait = 0;
+    qint64 totalRun = 0;
+    qint64 maxRun = 0;
+};
+
+#endif // NESTSERVER_H
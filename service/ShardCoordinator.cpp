@@ -0,0 +1,185 @@
+#include "ShardCoordinator.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QEventLoop>
+#include <QProcess>
+
+#include "LB_NestEngine.h"
+#include "LB_NestIO.h"
+
+namespace {
+
+const quint32 SHARD_MAGIC = 0x4e465053; // "NFPS"
+const quint32 SHARD_VERSION = 3;
+
+// one process writes the file, the first worker to open it, the others only read it (see LB_NFPStore)
+// so only the NFPs of that worker are added, the others' are computed again by the next run
+void UseStore(LB_NestEngine &engine, const QString &storeFile)
+{
+    if(storeFile.isEmpty())
+        return;
+    QSharedPointer<LB_NFPStore> store(new LB_NFPStore);
+    if(!store->Open(storeFile))
+        return;
+    QSharedPointer<LB_NFPCache> cache(new LB_NFPCache);
+    cache->SetStore(store);
+    engine.SetCache(cache);
+}
+
+}
+
+ShardCoordinator::ShardCoordinator(const LB_NestConfig &aConfig, int shardNumber) :
+    config(aConfig),
+    shardNb(qMax(1,shardNumber))
+{
+}
+
+bool ShardCoordinator::Run(const QVector<LB_Polygon2D> &parts)
+{
+    stripNb = 0;
+    placed.clear();
+    errorString.clear();
+
+    QVector<QVector<LB_Polygon2D>> shards = Split(parts);
+
+    // 1.start one worker per shard, they all run at the same time
+    // QProcess only moves the data of its pipes inside an event loop (or a waitFor call on that
+    // very process), so the jobs are written and the results read by one local loop for all of them
+    QEventLoop loop;
+    int running = 0;
+    QVector<QProcess *> workers;
+    QVector<QByteArray> results(shards.size());
+    for(int s = 0; s < shards.size(); ++s) {
+        QProcess *worker = new QProcess;
+        worker->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        // read as it comes, a worker never blocks on a full pipe
+        QObject::connect(worker,&QProcess::readyReadStandardOutput,&loop,[&results,worker,s]() {
+            results[s] += worker->readAllStandardOutput();
+        });
+        QObject::connect(worker,QOverload<int,QProcess::ExitStatus>::of(&QProcess::finished),&loop,[&,worker,s]() {
+            results[s] += worker->readAllStandardOutput();
+            if(--running == 0)
+                loop.quit();
+        });
+        // a worker which didn't start never finishes
+        QObject::connect(worker,&QProcess::errorOccurred,&loop,[&](QProcess::ProcessError error) {
+            if(error == QProcess::FailedToStart && --running == 0)
+                loop.quit();
+        });
+
+        QStringList arguments("--worker");
+        if(!storeFile.isEmpty())
+            arguments << "--nfp-store" << storeFile;
+        running++;
+        worker->start(QCoreApplication::applicationFilePath(),arguments);
+
+        QByteArray job;
+        QDataStream out(&job,QIODevice::WriteOnly);
+        out << SHARD_MAGIC << SHARD_VERSION << config << shards[s];
+        worker->write(job);
+        worker->closeWriteChannel();
+
+        workers.append(worker);
+    }
+    if(running > 0)
+        loop.exec();
+
+    // 2.collect the results, full strips are kept, the last strip of every shard is given back
+    QVector<LB_Polygon2D> leftover;
+    for(int s = 0; s < workers.size(); ++s) {
+        QProcess *worker = workers[s];
+        QByteArray result = results[s];
+        QDataStream in(result);
+        quint32 magic = 0, version = 0;
+        qint32 shardStrips = 0;
+        QVector<LB_Polygon2D> shardPlaced;
+        in >> magic >> version >> shardStrips >> shardPlaced;
+
+        if(worker->exitStatus() != QProcess::NormalExit || worker->exitCode() != 0 || in.status() != QDataStream::Ok
+                || magic != SHARD_MAGIC || version != SHARD_VERSION) {
+            errorString = QString("worker of shard %1 failed").arg(s);
+            qDeleteAll(workers);
+            return false;
+        }
+
+        foreach(LB_Polygon2D aPoly,shardPlaced) {
+            if(aPoly.ID() == shardStrips-1) {
+                leftover.append(aPoly);
+            }
+            else {
+                aPoly.SetID(stripNb+aPoly.ID());
+                placed.append(aPoly);
+            }
+        }
+        stripNb += qMax(0,shardStrips-1);
+    }
+    qDeleteAll(workers);
+
+    // 3.nest the parts of the partial strips together
+    // they are already rotated, so keep their orientation
+    if(!leftover.isEmpty()) {
+        LB_NestConfig leftoverConfig = config;
+        leftoverConfig.SetEnableRotation(false);
+
+        LB_NestEngine engine(leftoverConfig);
+        UseStore(engine,storeFile);
+        engine.SetPolygons(leftover);
+        engine.Run();
+
+        foreach(LB_Polygon2D aPoly,engine.Placed()) {
+            aPoly.SetID(stripNb+aPoly.ID());
+            placed.append(aPoly);
+        }
+        stripNb += engine.StripNumber();
+    }
+
+    return true;
+}
+
+int ShardCoordinator::RunWorker(QIODevice *in, QIODevice *out, const QString &storeFile)
+{
+    QByteArray job = in->readAll();
+    QDataStream jobStream(job);
+
+    quint32 magic = 0, version = 0;
+    LB_NestConfig aConfig;
+    QVector<LB_Polygon2D> parts;
+    jobStream >> magic >> version >> aConfig >> parts;
+    if(jobStream.status() != QDataStream::Ok || magic != SHARD_MAGIC || version != SHARD_VERSION)
+        return 1;
+
+    LB_NestEngine engine(aConfig);
+    UseStore(engine,storeFile);
+    engine.SetPolygons(parts);
+    engine.Run();
+
+    QByteArray result;
+    QDataStream resultStream(&result,QIODevice::WriteOnly);
+    resultStream << SHARD_MAGIC << SHARD_VERSION << qint32(engine.StripNumber()) << engine.Placed();
+    out->write(result);
+    return 0;
+}
+
+QVector<QVector<LB_Polygon2D>> ShardCoordinator::Split(const QVector<LB_Polygon2D> &parts) const
+{
+    // deal the parts by decreasing area, so every shard gets a similar mix of big and small ones
+    QVector<int> order(parts.size());
+    for(int i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    QVector<double> areas(parts.size());
+    for(int i = 0; i < parts.size(); ++i)
+        areas[i] = fabs(parts[i].Area());
+
+    std::stable_sort(order.begin(),order.end(),[&areas](int a, int b) {
+        return areas[a] > areas[b];
+    });
+
+    int number = qMin(shardNb,parts.size());
+    QVector<QVector<LB_Polygon2D>> shards(number);
+    for(int i = 0; i < order.size(); ++i) {
+        shards[i % number].append(parts[order[i]]);
+    }
+    return shards;
+}
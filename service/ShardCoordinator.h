@@ -0,0 +1,53 @@
+#ifndef SHARDCOORDINATOR_H
+#define SHARDCOORDINATOR_H
+
+#include <QIODevice>
+
+#include "LB_NestConfig.h"
+#include "LB_Polygon2D.h"
+using namespace NestConfig;
+using namespace Shape2D;
+
+// nests a large job with several worker processes
+// the parts are dealt into shards, every worker fills its own strips, then the
+// partially filled last strip of every shard is given back and nested once more here
+// jobs and results travel through the workers' stdin/stdout in the LB_NestIO binary form
+class ShardCoordinator
+{
+public:
+    ShardCoordinator(const LB_NestConfig &aConfig, int shardNumber);
+
+    bool Run(const QVector<LB_Polygon2D> &parts);
+
+    int StripNumber() const {
+        return stripNb;
+    }
+    const QVector<LB_Polygon2D> &Placed() const {
+        return placed;
+    }
+    QString ErrorString() const {
+        return errorString;
+    }
+
+    // the workers and the final pass read the NFPs of this file, none if empty
+    // the file has a single writer, the process opening it first, only its NFPs are added
+    void SetStoreFile(const QString &fileName) {
+        storeFile = fileName;
+    }
+
+    // worker side: reads one job from in, nests it and writes the result to out
+    static int RunWorker(QIODevice *in, QIODevice *out, const QString &storeFile = QString());
+
+private:
+    QVector<QVector<LB_Polygon2D>> Split(const QVector<LB_Polygon2D> &parts) const;
+
+    LB_NestConfig config;
+    int shardNb;
+    QString storeFile;
+
+    int stripNb = 0;
+    QVector<LB_Polygon2D> placed;
+    QString errorString;
+};
+
+#endif // SHARDCOORDINATOR_H
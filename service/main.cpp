@@ -0,0 +1,146 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <QThread>
+#include <QFile>
+
+#include "NestServer.h"
+#include "NestJson.h"
+#include "ShardCoordinator.h"
+#include "LB_NestIO.h"
+#include "LB_RasterExport.h"
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc,argv);
+    QCoreApplication::setApplicationName("NFPNestService");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Nesting job server listening on a local socket");
+    parser.addHelpOption();
+    QCommandLineOption nameOption(QStringList() << "n" << "name", "Local socket name.", "name", "nfpnest");
+    QCommandLineOption workerOption(QStringList() << "w" << "workers", "Number of worker threads.", "count", QString::number(QThread::idealThreadCount()));
+    QCommandLineOption shardOption("shards", "Nest --input with this number of worker processes and exit.", "count");
+    QCommandLineOption inputOption("input", "Polygon file (.fply) for --shards.", "file");
+    QCommandLineOption outputOption("output", "JSON result file for --shards, stdout by default.", "file");
+    QCommandLineOption widthOption("strip-width", "Strip width for --shards.", "mm", "1000");
+    QCommandLineOption heightOption("strip-height", "Strip height for --shards.", "mm", "1000");
+    QCommandLineOption gapOption("item-gap", "Item gap for --shards.", "mm", "0");
+    QCommandLineOption noRotationOption("no-rotation", "Disable rotation for --shards.");
+    QCommandLineOption rotationStepOption("rotation-step", "Try every part at multiples of this angle for --shards, 0 for its smallest bounding rectangle only.", "degree", "0");
+    QCommandLineOption imageOption("image", "Also render the --shards result, a .tif file or one .png per strip.", "file");
+    QCommandLineOption scaleOption("image-scale", "Pixels per mm of --image.", "scale", "1");
+    QCommandLineOption validateOption("validate", "Check the --shards result for overlapping parts.");
+    QCommandLineOption storeOption("nfp-store", "Keep the NFPs in this file across runs.", "file");
+    QCommandLineOption cacheOption("nfp-cache-points", "Points of all NFPs the server keeps in memory, 0 for no bound.", "count", "8000000");
+    QCommandLineOption compactOption("compact-nfp-store", "Compact the --nfp-store file and exit.");
+    QCommandLineOption shardWorkerOption("worker", "Internal: nest one shard read from stdin.");
+    parser.addOption(nameOption);
+    parser.addOption(workerOption);
+    parser.addOption(shardOption);
+    parser.addOption(inputOption);
+    parser.addOption(outputOption);
+    parser.addOption(widthOption);
+    parser.addOption(heightOption);
+    parser.addOption(gapOption);
+    parser.addOption(noRotationOption);
+    parser.addOption(rotationStepOption);
+    parser.addOption(imageOption);
+    parser.addOption(scaleOption);
+    parser.addOption(validateOption);
+    parser.addOption(storeOption);
+    parser.addOption(cacheOption);
+    parser.addOption(compactOption);
+    parser.addOption(shardWorkerOption);
+    parser.process(app);
+
+    if(parser.isSet(compactOption)) {
+        LB_NFPStore store;
+        if(!store.Open(parser.value(storeOption))) {
+            QTextStream(stderr) << store.ErrorString() << '\n';
+            return 1;
+        }
+        // another process writes it
+        if(!store.IsWritable()) {
+            QTextStream(stderr) << parser.value(storeOption) << " is in use\n";
+            return 1;
+        }
+        if(!store.Compact()) {
+            QTextStream(stderr) << store.ErrorString() << '\n';
+            return 1;
+        }
+        QTextStream(stdout) << store.Size() << " NFPs\n";
+        return 0;
+    }
+
+    if(parser.isSet(shardWorkerOption)) {
+        QFile in, out;
+        in.open(stdin,QIODevice::ReadOnly);
+        out.open(stdout,QIODevice::WriteOnly);
+        return ShardCoordinator::RunWorker(&in,&out,parser.value(storeOption));
+    }
+
+    if(parser.isSet(shardOption)) {
+        LB_NestConfig config;
+        config.SetStripWidth(parser.value(widthOption).toDouble());
+        config.SetStripHeight(parser.value(heightOption).toDouble());
+        config.SetItemGap(parser.value(gapOption).toDouble());
+        config.SetEnableRotation(!parser.isSet(noRotationOption));
+        config.SetRotationStep(parser.value(rotationStepOption).toDouble());
+
+        ShardCoordinator coordinator(config,parser.value(shardOption).toInt());
+        coordinator.SetStoreFile(parser.value(storeOption));
+        if(!coordinator.Run(NestIO::LoadPolygons(parser.value(inputOption)))) {
+            QTextStream(stderr) << coordinator.ErrorString() << '\n';
+            return 1;
+        }
+
+        if(parser.isSet(imageOption)) {
+            LB_RasterExport exporter(config);
+            exporter.SetScale(parser.value(scaleOption).toDouble());
+            exporter.SetLayout(coordinator.Placed());
+
+            QString imageName = parser.value(imageOption);
+            bool ok = imageName.endsWith(".tif",Qt::CaseInsensitive) || imageName.endsWith(".tiff",Qt::CaseInsensitive)
+                    ? exporter.ExportTiff(imageName) : exporter.ExportStrips(imageName);
+            if(!ok) {
+                QTextStream(stderr) << exporter.ErrorString() << '\n';
+                return 1;
+            }
+        }
+
+        QJsonObject result{{"strips",coordinator.StripNumber()},
+                           {"placements",NestJson::PolygonsToJson(coordinator.Placed())}};
+        if(parser.isSet(validateOption)) {
+            LB_LayoutValidator validator(config.StripWidth(),config.StripHeight());
+            result.insert("validation",NestJson::ValidationToJson(validator.Validate(coordinator.Placed())));
+        }
+        QFile out;
+        if(parser.isSet(outputOption)) {
+            out.setFileName(parser.value(outputOption));
+            if(!out.open(QIODevice::WriteOnly)) {
+                QTextStream(stderr) << "cannot write " << parser.value(outputOption) << '\n';
+                return 1;
+            }
+        }
+        else {
+            out.open(stdout,QIODevice::WriteOnly);
+        }
+        out.write(QJsonDocument(result).toJson(QJsonDocument::Compact));
+        return 0;
+    }
+
+    NestServer server;
+    server.SetWorkerNumber(parser.value(workerOption).toInt());
+    server.SetCacheCapacity(parser.value(cacheOption).toLongLong());
+    if(parser.isSet(storeOption) && !server.OpenStore(parser.value(storeOption))) {
+        QTextStream(stderr) << "cannot open " << parser.value(storeOption) << '\n';
+        return 1;
+    }
+    if(!server.Listen(parser.value(nameOption))) {
+        QTextStream(stderr) << "cannot listen on " << parser.value(nameOption) << '\n';
+        return 1;
+    }
+
+    return app.exec();
+}